@@ -2,8 +2,10 @@
 
 #include "../llvm_LinkAll.h"
 #include "../Utils/Utils.h"
+#include "../UndoLog/UndoLog.h"
 
 #include <cstdio>
+#include <algorithm>
 
 using namespace dale::ErrorInst;
 
@@ -15,6 +17,10 @@ Context::Context()
     this->er = NULL;
     this->tr = NULL;
 
+    visible_function_generation = -1;
+    visible_variable_generation = -1;
+    visible_struct_generation   = -1;
+
     /* For serialisation use only. Native types and an error reporter
      * must be set post-deserialisation. */
 }
@@ -33,6 +39,10 @@ Context::Context(ErrorReporter *er,
 
     active_ns_nodes.push_back(namespaces);
     used_ns_nodes.push_back(namespaces);
+
+    visible_function_generation = -1;
+    visible_variable_generation = -1;
+    visible_struct_generation   = -1;
 }
 
 void
@@ -47,6 +57,8 @@ Context::deleteNamespaces(NSNode *node)
     }
     delete node->ns;
     delete node;
+
+    clearVisibleBindings();
 }
 
 Context::~Context()
@@ -109,6 +121,8 @@ Context::activateNamespace(const char *name)
             new_namespaces
         )
     );
+    UndoLog::addNamespaceChange(current_nsnode, new_namespaces, name);
+    ns_node_lookups.clear();
 
     active_ns_nodes.push_back(new_namespaces);
     used_ns_nodes.push_back(new_namespaces);
@@ -213,8 +227,25 @@ Context::getNSNode(const char *name,
 NSNode *
 Context::getNSNode(const char *name, bool ignore_last)
 {
+    if (name[0] == '.') {
+        return namespaces;
+    }
+
+    NSNode *active = active_ns_nodes.back();
+    std::string key(reinterpret_cast<const char *>(&active),
+                    sizeof(active));
+    key.push_back(ignore_last ? '1' : '0');
+    key.append(name);
+
+    HashMap<NSNode *>::iterator iter = ns_node_lookups.find(key);
+    if (iter != ns_node_lookups.end()) {
+        return iter->second;
+    }
+
     std::vector<std::string> ns_parts;
-    return getNSNode(name, ignore_last, &ns_parts);
+    NSNode *nsnode = getNSNode(name, ignore_last, &ns_parts);
+    ns_node_lookups.insert(std::pair<std::string, NSNode *>(key, nsnode));
+    return nsnode;
 }
 
 Namespace *
@@ -302,7 +333,7 @@ existsNonExternCFunctionInList(std::vector<Function *> *fn_list)
 bool
 Context::existsNonExternCFunction(const char *name)
 {
-    std::map<std::string, std::vector<Function *> *>::iterator
+    HashMap<std::vector<Function *> *>::iterator
         iter;
 
     const char *fn_name;
@@ -320,17 +351,16 @@ Context::existsNonExternCFunction(const char *name)
         }
     }
 
-    for (std::vector<NSNode *>::reverse_iterator
-            rb = used_ns_nodes.rbegin(),
-            re = used_ns_nodes.rend();
-            rb != re;
-            ++rb) {
-        iter = (*rb)->ns->functions.find(name);
-        if (iter != (*rb)->ns->functions.end()) {
-            bool res = existsNonExternCFunctionInList(iter->second);
-            if (res) {
-                return true;
-            }
+    std::vector<Namespace *> *nss = getVisibleFunctionNamespaces(name);
+    for (std::vector<Namespace *>::iterator
+            b = nss->begin(),
+            e = nss->end();
+            b != e;
+            ++b) {
+        iter = (*b)->functions.find(name);
+        bool res = existsNonExternCFunctionInList(iter->second);
+        if (res) {
+            return true;
         }
     }
 
@@ -355,7 +385,7 @@ existsExternCFunctionInList(std::vector<Function *> *fn_list)
 bool
 Context::existsExternCFunction(const char *name)
 {
-    std::map<std::string, std::vector<Function *> *>::iterator
+    HashMap<std::vector<Function *> *>::iterator
         iter;
 
     const char *fn_name;
@@ -373,17 +403,16 @@ Context::existsExternCFunction(const char *name)
         }
     }
 
-    for (std::vector<NSNode *>::reverse_iterator
-            rb = used_ns_nodes.rbegin(),
-            re = used_ns_nodes.rend();
-            rb != re;
-            ++rb) {
-        iter = (*rb)->ns->functions.find(name);
-        if (iter != (*rb)->ns->functions.end()) {
-            bool res = existsExternCFunctionInList(iter->second);
-            if (res) {
-                return true;
-            }
+    std::vector<Namespace *> *nss = getVisibleFunctionNamespaces(name);
+    for (std::vector<Namespace *>::iterator
+            b = nss->begin(),
+            e = nss->end();
+            b != e;
+            ++b) {
+        iter = (*b)->functions.find(name);
+        bool res = existsExternCFunctionInList(iter->second);
+        if (res) {
+            return true;
         }
     }
 
@@ -409,7 +438,7 @@ isOverloadedFunctionInList(Function *fn,
 bool
 Context::isOverloadedFunction(const char *name)
 {
-    std::map<std::string, std::vector<Function *> *>::iterator
+    HashMap<std::vector<Function *> *>::iterator
         iter;
 
     if (strchr(name, '.')) {
@@ -431,24 +460,137 @@ Context::isOverloadedFunction(const char *name)
 
     Function *check_fn = NULL;
 
+    std::vector<Namespace *> *nss = getVisibleFunctionNamespaces(name);
+    for (std::vector<Namespace *>::iterator
+            b = nss->begin(),
+            e = nss->end();
+            b != e;
+            ++b) {
+        iter = (*b)->functions.find(name);
+        if (!check_fn) {
+            check_fn = iter->second->front();
+        }
+        if (isOverloadedFunctionInList(check_fn,
+                                       iter->second)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template <typename T>
+static void
+refreshVisibleCache(HashMap<T> *cache, int *generation,
+                    BindingChanges *changes)
+{
+    if (*generation == changes->generation) {
+        return;
+    }
+    if (((*generation + 1) == changes->generation)
+            && !changes->name.empty()) {
+        cache->erase(changes->name);
+    } else {
+        cache->clear();
+    }
+    *generation = changes->generation;
+}
+
+template <typename T, typename U>
+static void
+eraseVisibleNames(HashMap<T> *cache, HashMap<U> *names)
+{
+    if (names->size() > cache->size()) {
+        cache->clear();
+        return;
+    }
+    for (typename HashMap<U>::iterator b = names->begin(),
+                                       e = names->end();
+            b != e;
+            ++b) {
+        cache->erase(b->first);
+    }
+}
+
+void
+Context::eraseVisibleBindings(Namespace *ns)
+{
+    eraseVisibleNames(&visible_functions, &(ns->functions));
+    eraseVisibleNames(&visible_variables, &(ns->variables));
+    eraseVisibleNames(&visible_structs,   &(ns->structs));
+}
+
+void
+Context::clearVisibleBindings()
+{
+    visible_functions.clear();
+    visible_variables.clear();
+    visible_structs.clear();
+    visible_scope.clear();
+    ns_node_lookups.clear();
+}
+
+void
+Context::refreshVisibleBindings()
+{
+    refreshVisibleCache(&visible_functions, &visible_function_generation,
+                        &Namespace::function_changes);
+    refreshVisibleCache(&visible_variables, &visible_variable_generation,
+                        &Namespace::variable_changes);
+    refreshVisibleCache(&visible_structs, &visible_struct_generation,
+                        &Namespace::struct_changes);
+
+    if (used_ns_nodes == visible_scope) {
+        return;
+    }
+
+    size_t used_count    = used_ns_nodes.size();
+    size_t visible_count = visible_scope.size();
+
+    if ((used_count == (visible_count + 1))
+            && std::equal(visible_scope.begin(), visible_scope.end(),
+                          used_ns_nodes.begin())) {
+        eraseVisibleBindings(used_ns_nodes.back()->ns);
+    } else if ((visible_count == (used_count + 1))
+            && std::equal(used_ns_nodes.begin(), used_ns_nodes.end(),
+                          visible_scope.begin())) {
+        eraseVisibleBindings(visible_scope.back()->ns);
+    } else {
+        visible_functions.clear();
+        visible_variables.clear();
+        visible_structs.clear();
+    }
+
+    visible_scope = used_ns_nodes;
+}
+
+std::vector<Namespace *> *
+Context::getVisibleFunctionNamespaces(const char *name)
+{
+    refreshVisibleBindings();
+
+    std::string ss_name(name);
+    HashMap<std::vector<Namespace *> >::iterator
+        iter = visible_functions.find(ss_name);
+    if (iter != visible_functions.end()) {
+        return &(iter->second);
+    }
+
+    std::vector<Namespace *> nss;
     for (std::vector<NSNode *>::reverse_iterator
             rb = used_ns_nodes.rbegin(),
             re = used_ns_nodes.rend();
             rb != re;
             ++rb) {
-        iter = (*rb)->ns->functions.find(name);
-        if (iter != (*rb)->ns->functions.end()) {
-            if (!check_fn) {
-                check_fn = iter->second->front();
-            }
-            if (isOverloadedFunctionInList(check_fn,
-                                           iter->second)) {
-                return true;
-            }
+        if ((*rb)->ns->functions.count(ss_name)) {
+            nss.push_back((*rb)->ns);
         }
     }
 
-    return false;
+    iter = visible_functions.insert(
+        std::pair<std::string, std::vector<Namespace *> >(ss_name, nss)
+    ).first;
+    return &(iter->second);
 }
 
 Function *
@@ -481,13 +623,14 @@ Context::getFunction(const char *name,
         return getFunction_(ns, fn_name, types, closest_fn, is_macro);
     }
 
-    for (std::vector<NSNode *>::reverse_iterator
-            rb = used_ns_nodes.rbegin(),
-            re = used_ns_nodes.rend();
-            rb != re;
-            ++rb) {
+    std::vector<Namespace *> *nss = getVisibleFunctionNamespaces(name);
+    for (std::vector<Namespace *>::iterator
+            b = nss->begin(),
+            e = nss->end();
+            b != e;
+            ++b) {
         Function *fn =
-            getFunction_((*rb)->ns, name, types, closest_fn, is_macro);
+            getFunction_((*b), name, types, closest_fn, is_macro);
         if (fn) {
             return fn;
         }
@@ -516,18 +659,29 @@ Context::getVariable(const char *name)
         return ns->getVariable(var_name);
     }
 
+    refreshVisibleBindings();
+    std::string ss_name(name);
+    HashMap<Variable *>::iterator iter = visible_variables.find(ss_name);
+    if (iter != visible_variables.end()) {
+        return iter->second;
+    }
+
+    Variable *var = NULL;
     for (std::vector<NSNode *>::reverse_iterator
             rb = used_ns_nodes.rbegin(),
             re = used_ns_nodes.rend();
             rb != re;
             ++rb) {
-        Variable *var = (*rb)->ns->getVariable(name);
+        var = (*rb)->ns->getVariable(name);
         if (var) {
-            return var;
+            break;
         }
     }
 
-    return NULL;
+    visible_variables.insert(
+        std::pair<std::string, Variable *>(ss_name, var)
+    );
+    return var;
 }
 
 Struct *
@@ -542,18 +696,27 @@ Context::getStruct(const char *name)
         return ns->getStruct(st_name);
     }
 
+    refreshVisibleBindings();
+    std::string ss_name(name);
+    HashMap<Struct *>::iterator iter = visible_structs.find(ss_name);
+    if (iter != visible_structs.end()) {
+        return iter->second;
+    }
+
+    Struct *st = NULL;
     for (std::vector<NSNode *>::reverse_iterator
             rb = used_ns_nodes.rbegin(),
             re = used_ns_nodes.rend();
             rb != re;
             ++rb) {
-        Struct *st = (*rb)->ns->getStruct(name);
+        st = (*rb)->ns->getStruct(name);
         if (st) {
-            return st;
+            break;
         }
     }
 
-    return NULL;
+    visible_structs.insert(std::pair<std::string, Struct *>(ss_name, st));
+    return st;
 }
 
 Struct *
@@ -747,8 +910,23 @@ Context::getFunctionNames(std::set<std::string> *names,
     getFunctionNames_(names, prefix, namespaces);
 }
 
+void relink_(NSNode *nsnode);
+
+void
+getBindings_(NSNode *nsnode, NewBindings *added)
+{
+    for (std::map<std::string, NSNode *>::iterator
+            b = nsnode->children.begin(),
+            e = nsnode->children.end();
+            b != e;
+            ++b) {
+        getBindings_(b->second, added);
+    }
+    nsnode->ns->getBindings(added);
+}
+
 bool
-merge_(NSNode *nsnode_dst, NSNode *nsnode_src)
+merge_(NSNode *nsnode_dst, NSNode *nsnode_src, NewBindings *added)
 {
     Namespace *ns_dst = nsnode_dst->ns;
     Namespace *ns_src = nsnode_src->ns;
@@ -761,26 +939,32 @@ merge_(NSNode *nsnode_dst, NSNode *nsnode_src)
         std::map<std::string, NSNode *>::iterator dst_m =
             nsnode_dst->children.find(src_b->first);
         if (dst_m != nsnode_dst->children.end()) {
-            merge_(dst_m->second, src_b->second);
+            merge_(dst_m->second, src_b->second, added);
         } else {
             src_b->second->ns->parent_namespace = ns_dst;
+            relink_(src_b->second);
             nsnode_dst->children.insert(
                 std::pair<std::string, NSNode *>(
                     src_b->first, src_b->second
                 )
             );
+            if (added) {
+                getBindings_(src_b->second, added);
+            }
         }
     }
 
-    ns_dst->merge(ns_src);
+    ns_dst->merge(ns_src, added);
 
     return true;
 }
 
 bool
-Context::merge(Context *other)
+Context::merge(Context *other, NewBindings *added)
 {
-    return merge_(namespaces, other->namespaces);
+    clearLLVMTypes();
+    clearVisibleBindings();
+    return merge_(namespaces, other->namespaces, added);
 }
 
 bool
@@ -797,20 +981,6 @@ regetPointers_(llvm::Module *mod, NSNode *nsnode)
     return true;
 }
 
-bool
-regetFunctionPointers(llvm::Module *mod, NSNode *nsnode)
-{
-    for (std::map<std::string, NSNode *>::iterator
-            b = nsnode->children.begin(),
-            e = nsnode->children.end();
-            b != e;
-            ++b) {
-        regetFunctionPointers(mod, b->second);
-    }
-    nsnode->ns->regetFunctionPointers(mod);
-    return true;
-}
-
 bool
 Context::rebuildFunction(Function *fn, const char *name,
                          llvm::Module *mod)
@@ -869,8 +1039,9 @@ Context::rebuildFunctions(llvm::Module *mod, NSNode *nsnode)
     }
 
     Namespace *ns = nsnode->ns;
+    ns->clearFunctionLookups();
 
-    std::map<std::string, std::vector<Function *>* >::iterator
+    HashMap<std::vector<Function *> *>::iterator
         b, e;
 
     for (b = ns->functions.begin(), e = ns->functions.end(); b != e; ++b) {
@@ -933,7 +1104,7 @@ Context::rebuildVariables(llvm::Module *mod, NSNode *nsnode)
 
     Namespace *ns = nsnode->ns;
 
-    for (std::map<std::string, Variable *>::iterator
+    for (HashMap<Variable *>::iterator
             b = ns->variables.begin(),
             e = ns->variables.end();
             b != e;
@@ -967,18 +1138,55 @@ Context::toLLVMLinkage(int linkage)
 bool
 Context::regetPointers(llvm::Module *mod)
 {
+    clearLLVMTypes();
     regetPointers_(mod, namespaces);
     rebuildFunctions(mod, namespaces);
     return true;
 }
 
 bool
-Context::regetPointersForNewModule(llvm::Module *mod)
+Context::regetPointersForNewModule(llvm::Module *mod,
+                                   NewBindings *added)
 {
-    regetPointers_(mod, namespaces);
-    rebuildVariables(mod, namespaces);
-    rebuildFunctions(mod, namespaces);
-    regetFunctionPointers(mod, namespaces);
+    clearLLVMTypes();
+
+    for (std::vector<Struct *>::iterator
+            b = added->structs.begin(),
+            e = added->structs.end();
+            b != e;
+            ++b) {
+        Namespace::regetStructPointer((*b), mod);
+    }
+
+    for (std::vector<std::pair<std::string, Variable *> >::iterator
+            b = added->variables.begin(),
+            e = added->variables.end();
+            b != e;
+            ++b) {
+        Namespace::regetVariablePointer(b->second, mod);
+        rebuildVariable(b->second, b->first.c_str(), mod);
+    }
+
+    for (std::set<Namespace *>::iterator
+            b = added->function_namespaces.begin(),
+            e = added->function_namespaces.end();
+            b != e;
+            ++b) {
+        (*b)->clearFunctionLookups();
+    }
+
+    for (std::vector<std::pair<std::string, Function *> >::iterator
+            b = added->functions.begin(),
+            e = added->functions.end();
+            b != e;
+            ++b) {
+        Function *fn = b->second;
+        fn->llvm_function = mod->getFunction(fn->internal_name.c_str());
+        if (!fn->llvm_function) {
+            rebuildFunction(fn, b->first.c_str(), mod);
+        }
+    }
+
     return true;
 }
 
@@ -1117,10 +1325,46 @@ Context::toLLVMTypeStruct(Type *type,
     return NULL;
 }
 
+void
+Context::clearLLVMTypes()
+{
+    llvm_types.clear();
+}
+
 llvm::Type *
 Context::toLLVMType_(Type *type,
                      Node *n,
                      bool refs_to_pointers)
+{
+    /* Only registered types are cached, since other types may be
+     * modified by their owners.  The reference flag is part of the
+     * key, because it is cleared temporarily when converting a
+     * reference into a pointer. */
+    if (!type->is_registered) {
+        return toLLVMTypeUncached(type, n, refs_to_pointers);
+    }
+
+    std::pair<Type *, int> key(type, (refs_to_pointers ? 1 : 0)
+                                     | (type->is_reference ? 2 : 0));
+    std::map<std::pair<Type *, int>, llvm::Type *>::iterator
+        b = llvm_types.find(key);
+    if (b != llvm_types.end()) {
+        return b->second;
+    }
+
+    llvm::Type *llvm_type = toLLVMTypeUncached(type, n, refs_to_pointers);
+    if (llvm_type) {
+        llvm_types.insert(
+            std::pair<std::pair<Type *, int>, llvm::Type *>(key, llvm_type)
+        );
+    }
+    return llvm_type;
+}
+
+llvm::Type *
+Context::toLLVMTypeUncached(Type *type,
+                            Node *n,
+                            bool refs_to_pointers)
 {
     llvm::LLVMContext &lc = llvm::getGlobalContext();
 
@@ -1280,12 +1524,14 @@ bool
 Context::removeUnneeded(std::set<std::string> *forms,
                         std::set<std::string> *found_forms)
 {
+    clearLLVMTypes();
     return removeUnneeded_(forms, found_forms, namespaces);
 }
 
 bool
 eraseOnceForms_(std::set<std::string> *once_tags,
                 llvm::Module *mod,
+                std::set<std::string> *erased_functions,
                 NSNode *nsnode)
 {
     for (std::map<std::string, NSNode *>::iterator
@@ -1293,9 +1539,9 @@ eraseOnceForms_(std::set<std::string> *once_tags,
             e = nsnode->children.end();
             b != e;
             ++b) {
-        eraseOnceForms_(once_tags, mod, b->second);
+        eraseOnceForms_(once_tags, mod, erased_functions, b->second);
     }
-    nsnode->ns->eraseOnceFunctions(once_tags, mod);
+    nsnode->ns->eraseOnceFunctions(once_tags, mod, erased_functions);
     nsnode->ns->eraseOnceVariables(once_tags, mod);
 
     return true;
@@ -1303,9 +1549,10 @@ eraseOnceForms_(std::set<std::string> *once_tags,
 
 bool
 Context::eraseOnceForms(std::set<std::string> *once_tags,
-                        llvm::Module *mod)
+                        llvm::Module *mod,
+                        std::set<std::string> *erased_functions)
 {
-    return eraseOnceForms_(once_tags, mod, namespaces);
+    return eraseOnceForms_(once_tags, mod, erased_functions, namespaces);
 }
 
 void
@@ -1379,6 +1626,7 @@ deleteAnonymousNamespaces_(NSNode *nsnode)
 bool
 Context::deleteAnonymousNamespaces()
 {
+    clearVisibleBindings();
     return deleteAnonymousNamespaces_(namespaces);
 }
 
@@ -12,6 +12,7 @@
 #include "../NativeTypes/NativeTypes.h"
 #include "../TypeRegister/TypeRegister.h"
 #include "../STL/STL.h"
+#include "../HashMap/HashMap.h"
 
 #include <vector>
 #include <string>
@@ -63,6 +64,9 @@ public:
     std::vector<NSNode *> used_ns_nodes;
     /*! The current label-variable index for the context. */
     int lv_index;
+    /*! The LLVM types for registered types, keyed by the type and by
+     *  the flags that affect its conversion. */
+    std::map<std::pair<Type *, int>, llvm::Type *> llvm_types;
 
     /*! The void constructor, intended solely for use by the
      *  deserialisation procedures.
@@ -130,6 +134,8 @@ public:
      *  @param name The name of the namespace.
      *  @param ignore_last Whether to ignore the last segment of the
      *  argument name.
+     *
+     *  Results are cached until the tree of namespaces changes.
      */
     NSNode *getNSNode(const char *name,
                       bool ignore_last);
@@ -173,12 +179,22 @@ public:
      *  @param name The name of the function.
      */
     bool isOverloadedFunction(const char *name);
+    /*! Get the used namespaces that bind the given function name.
+     *  @param name The (unqualified) name of the function.
+     *
+     *  The namespaces are ordered from the most recently-used
+     *  outwards.  The returned vector is owned by the context, and is
+     *  only valid until the next lookup.
+     */
+    std::vector<Namespace *> *getVisibleFunctionNamespaces(
+        const char *name
+    );
 
     /*! Get the function with the given name and arguments.
      *
      *  See Namespace::getFunction, the parameters for which are the
-     *  same.  This iterates over the used namespaces, calling that
-     *  method.
+     *  same.  This iterates over the used namespaces that bind the
+     *  name (see getVisibleFunctionNamespaces), calling that method.
      */
     Function *getFunction(const char *name,
                                    std::vector<Type *> *types,
@@ -194,8 +210,9 @@ public:
                                    bool is_macro);
     /*! Get the variable with the given name.
      *
-     *  See Namespace::getVariable.  As per getFunction, this iterates
-     *  over the used namespaces, calling that method.
+     *  See Namespace::getVariable.  Unqualified lookups are cached
+     *  per name until the used namespaces or the variable bindings
+     *  change.
      */
     Variable *getVariable(const char *name);
     /*! Get the struct with the given name.
@@ -247,10 +264,13 @@ public:
     /*! Merge another context into this one.
      *  @param other The other context.
      *
+     *  @param added An optional object for recording the bindings
+     *  that were added to this context.
+     *
      *  The active/used namespaces in the other context are ignored:
      *  this is just about the bindings.
      */
-    bool merge(Context *other);
+    bool merge(Context *other, NewBindings *added = NULL);
 
     /*! Convert a Dale type into an LLVM type.
      *  @param type The Dale type.
@@ -272,6 +292,9 @@ public:
     llvm::Type *toLLVMType_(Type *type,
                             Node *n,
                             bool refs_to_pointers);
+    llvm::Type *toLLVMTypeUncached(Type *type,
+                                   Node *n,
+                                   bool refs_to_pointers);
     llvm::Type *toLLVMTypeStruct(Type *type,
                                  Node *n);
     llvm::Type *toLLVMTypeBase(Type *type,
@@ -285,6 +308,14 @@ public:
     llvm::Type *toLLVMTypeArray(Type *type,
                                 Node *n);
 
+    /*! Clear the cached LLVM types.
+     *
+     *  This must be called whenever the LLVM type of a struct may
+     *  have changed, e.g. when pointers are refetched from a new
+     *  module, or when a struct or namespace is removed.
+     */
+    void clearLLVMTypes();
+
     /*! Convert a Dale linkage into an LLVM linkage.
      *  @param linkage The Dale linkage.
      */
@@ -294,13 +325,17 @@ public:
      *  @param mod The LLVM module.
      */
     bool regetPointers(llvm::Module *mod);
-    /*! Reget all LLVM types/values/functions from the module.
+    /*! Reget the LLVM types/values/functions for new bindings from
+     *  the module.
      *  @param mod The LLVM module.
+     *  @param added The bindings added by the merge.
      *
      *  Should be used immediately after merging a new module's
-     *  context.
+     *  context.  Bindings that were present before the merge already
+     *  refer to the module, so they are not refetched.
      */
-    bool regetPointersForNewModule(llvm::Module *mod);
+    bool regetPointersForNewModule(llvm::Module *mod,
+                                   NewBindings *added);
     /*! Rebuilds a single LLVM function.
      *  @param fn The function to rebuild.
      *  @param name The function's name (unmangled).
@@ -350,12 +385,15 @@ public:
      *  given 'once' tag.
      *  @param once_tags The current set of 'once' tags.
      *  @param mod The LLVM module to use for erasure.
+     *  @param erased_functions A set to which the names of functions
+     *                          with erased bodies are added.
      *
      *  See Namespace::eraseOnceFunctions and
      *  Namespace::eraseOnceVariables.
      */
     bool eraseOnceForms(std::set<std::string> *once_tags,
-                        llvm::Module *mod);
+                        llvm::Module *mod,
+                        std::set<std::string> *erased_functions);
     /*! Delete all anonymous namespaces from this context.
      */
     bool deleteAnonymousNamespaces();
@@ -374,6 +412,44 @@ public:
 
     /*! Print the context's details to stderr. */
     void print();
+
+private:
+    /*! The bindings visible from the used namespaces, by unqualified
+     *  name.  For functions, this is the list of used namespaces
+     *  that bind the name; for variables and structs, it is the
+     *  innermost binding.  Names without a visible binding are
+     *  cached as well. */
+    HashMap<std::vector<Namespace *> > visible_functions;
+    HashMap<Variable *> visible_variables;
+    HashMap<Struct *> visible_structs;
+    /*! The used namespace nodes as at the last refresh of the visible
+     *  bindings. */
+    std::vector<NSNode *> visible_scope;
+    /*! The binding generations (see Namespace::function_changes
+     *  etc.) as at the last refresh of the visible bindings. */
+    int visible_function_generation;
+    int visible_variable_generation;
+    int visible_struct_generation;
+    /*! Resolved namespace nodes, keyed by the active namespace node,
+     *  the ignore_last flag and the name (see getNSNode). */
+    HashMap<NSNode *> ns_node_lookups;
+
+    /*! Bring the visible bindings up to date with the used
+     *  namespaces and the binding generations.
+     *
+     *  If a single namespace has been used or unused since the last
+     *  refresh, then only that namespace's names are removed from
+     *  the caches; if a single binding has been added or removed,
+     *  then only that binding's name is removed.  Otherwise, the
+     *  relevant caches are cleared.
+     */
+    void refreshVisibleBindings();
+    /*! Remove the given namespace's names from the visible bindings.
+     *  @param ns The namespace.
+     */
+    void eraseVisibleBindings(Namespace *ns);
+    /*! Clear the visible bindings and the namespace node lookups. */
+    void clearVisibleBindings();
 };
 }
 
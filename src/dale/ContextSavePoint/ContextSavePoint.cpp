@@ -2,79 +2,87 @@
 
 #include "../llvm_LinkAll.h"
 #include "../NativeTypes/NativeTypes.h"
+#include "../UndoLog/UndoLog.h"
+
+#include <set>
 
 namespace dale
 {
-void
-makeNamespaceSavePoints(NSNode *nsnode, SPNode *spnode)
-{
-    spnode->nsp = new NamespaceSavePoint(nsnode->ns);
-
-    for (std::map<std::string, NSNode *>::iterator
-            b = nsnode->children.begin(),
-            e = nsnode->children.end();
-            b != e;
-            ++b) {
-        SPNode *sub_nsp = new SPNode();
-        makeNamespaceSavePoints(b->second, sub_nsp);
-        spnode->children.insert(
-            std::pair<std::string, SPNode*>(
-                b->first, sub_nsp
-            )
-        );
-    }
-
-    return;
-}
-
 ContextSavePoint::ContextSavePoint(Context *ctx)
 {
     active = ctx->active_ns_nodes.back();
-    nsps = new SPNode();
-    makeNamespaceSavePoints(active, nsps);
     src_ctx = ctx;
     active_count = src_ctx->active_ns_nodes.size();
     used_count   = src_ctx->used_ns_nodes.size();
+    log_index    = UndoLog::begin();
 }
 
 ContextSavePoint::~ContextSavePoint()
 {
+    UndoLog::end();
 }
 
-bool
-restore_(SPNode *spnode)
+static bool
+isWithinNamespace(Namespace *ns, Namespace *ancestor)
 {
-    for (std::map<std::string, SPNode*>::iterator
-            b = spnode->children.begin(),
-            e = spnode->children.end();
-            b != e;
-            ++b) {
-        restore_(b->second);
+    while (ns) {
+        if (ns == ancestor) {
+            return true;
+        }
+        ns = ns->parent_namespace;
     }
-    spnode->nsp->restore();
-
-    return true;
+    return false;
 }
 
-bool
-eraseUnneeded(Context *ctx, SPNode *spnode, NSNode *nsnode)
+static void
+undoFunctionChange(UndoLog::Change *change)
 {
-    for (std::map<std::string, NSNode*>::iterator
-            b = nsnode->children.begin(),
-            e = nsnode->children.end();
-            b != e;
-            ++b) {
-        std::map<std::string, SPNode*>::iterator spb =
-            spnode->children.find(b->first);
-        if (spb == spnode->children.end()) {
-            ctx->deleteNamespaces(b->second);
-            nsnode->children.erase(b);
-        } else {
-            eraseUnneeded(ctx, spb->second, b->second);
+    /* Overload lists that were created after the save point are left
+     * as they are. */
+    std::vector<Function *> *fn_list = change->fn_list;
+    int to_remove = fn_list->size() - change->fn_list_size;
+    while (to_remove-- > 0) {
+        if (fn_list->back()->llvm_function) {
+            fn_list->back()->llvm_function->eraseFromParent();
         }
+        fn_list->pop_back();
+    }
+    change->ns->clearFunctionLookups(change->name);
+}
+
+static void
+undoBindingChange(UndoLog::Change *change)
+{
+    Namespace *ns = change->ns;
+    switch (change->type) {
+        case UndoLog::VariableAdded:
+            Namespace::variable_changes.add(ns->variables_ordered.back());
+            ns->variables.erase(ns->variables_ordered.back());
+            ns->variables_ordered.pop_back();
+            break;
+        case UndoLog::StructAdded:
+            Namespace::struct_changes.add(ns->structs_ordered.back());
+            ns->structs.erase(ns->structs_ordered.back());
+            ns->structs_ordered.pop_back();
+            break;
+        case UndoLog::EnumAdded:
+            ns->enums.erase(ns->enums_ordered.back());
+            ns->enums_ordered.pop_back();
+            break;
     }
+}
 
-    return true;
+static void
+undoNamespaceChange(Context *ctx, UndoLog::Change *change)
+{
+    std::map<std::string, NSNode *> *children =
+        &(change->parent_nsnode->children);
+    std::map<std::string, NSNode *>::iterator b =
+        children->find(change->name);
+    if ((b != children->end()) && (b->second == change->nsnode)) {
+        children->erase(b);
+        ctx->deleteNamespaces(change->nsnode);
+    }
 }
 
 bool
@@ -91,8 +99,59 @@ ContextSavePoint::restore()
         current_used_count--;
     }
 
-    restore_(nsps);
-    eraseUnneeded(src_ctx, nsps, active);
+    std::vector<UndoLog::Change> *changes = UndoLog::getChanges();
+
+    std::set<std::vector<Function *> *> new_fn_lists;
+    for (std::vector<UndoLog::Change>::iterator
+            b = changes->begin() + log_index,
+            e = changes->end();
+            b != e;
+            ++b) {
+        if ((b->type == UndoLog::FunctionAdded)
+                && (b->fn_list_size == -1)) {
+            new_fn_lists.insert(b->fn_list);
+        }
+    }
+
+    /* Changes are undone from the most recent backwards.  Changes to
+     * namespaces outside the active namespace are kept, so that an
+     * enclosing save point can still undo them. */
+    std::vector<UndoLog::Change> kept;
+    while ((int) changes->size() > log_index) {
+        UndoLog::Change change = changes->back();
+        changes->pop_back();
+
+        if (change.type == UndoLog::Removed) {
+            continue;
+        }
+        if ((change.type == UndoLog::LabelAdded)
+                || !isWithinNamespace(change.ns, active->ns)) {
+            kept.push_back(change);
+            continue;
+        }
+        switch (change.type) {
+            case UndoLog::FunctionAdded:
+                if (new_fn_lists.find(change.fn_list)
+                        == new_fn_lists.end()) {
+                    undoFunctionChange(&change);
+                }
+                break;
+            case UndoLog::VariableAdded:
+            case UndoLog::EnumAdded:
+                undoBindingChange(&change);
+                break;
+            case UndoLog::StructAdded:
+                undoBindingChange(&change);
+                src_ctx->clearLLVMTypes();
+                break;
+            case UndoLog::NamespaceAdded:
+                undoNamespaceChange(src_ctx, &change);
+                src_ctx->clearLLVMTypes();
+                break;
+        }
+    }
+    changes->insert(changes->end(), kept.rbegin(), kept.rend());
+
     return true;
 }
 }
@@ -2,18 +2,9 @@
 #define DALE_CONTEXT_SAVEPOINT
 
 #include "../Context/Context.h"
-#include "../NamespaceSavePoint/NamespaceSavePoint.h"
-
-#include <string>
-#include <map>
 
 namespace dale
 {
-struct SPNode
-{
-    NamespaceSavePoint *nsp;
-    std::map<std::string, SPNode *> children;
-};
 /*! ContextSavePoint
 
     A class for storing the state of a context at a given time, and
@@ -21,15 +12,20 @@ struct SPNode
     only used when determining whether a given binding is a macro or a
     function, so that anything done in order to make that
     determination can be reversed.
+
+    Changes are recorded in the UndoLog while the save point exists.
+    Restoring the save point undoes the changes that were made to the
+    namespace that was active when the save point was created, and to
+    the namespaces beneath it.
 */
 class ContextSavePoint
 {
 private:
     Context *src_ctx;
-    SPNode *nsps;
     NSNode *active;
     int active_count;
     int used_count;
+    int log_index;
 
 public:
     /*! Construct a new savepoint using the given context.
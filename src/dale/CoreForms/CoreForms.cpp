@@ -1,4 +1,5 @@
 #include "CoreForms.h"
+#include "../HashMap/HashMap.h"
 
 #include <set>
 #include <map>
@@ -56,9 +57,9 @@ namespace dale
 {
 namespace CoreForms
 {
-std::map<std::string, standard_core_form_t> standard_core_forms;
-std::map<std::string, macro_core_form_t> macro_core_forms;
-std::map<std::string, toplevel_core_form_t> toplevel_core_forms;
+HashMap<standard_core_form_t> standard_core_forms;
+HashMap<macro_core_form_t> macro_core_forms;
+HashMap<toplevel_core_form_t> toplevel_core_forms;
 std::set<std::string> core_forms_no_override;
 
 const int core_forms_no_override_max = 31;
@@ -148,7 +149,7 @@ existsNoOverride(const char *name)
 standard_core_form_t
 getStandard(const char *name)
 {
-    std::map<std::string, standard_core_form_t>::iterator b =
+    HashMap<standard_core_form_t>::iterator b =
         standard_core_forms.find(name);
     if (b == standard_core_forms.end()) {
         return NULL;
@@ -159,7 +160,7 @@ getStandard(const char *name)
 macro_core_form_t
 getMacro(const char *name)
 {
-    std::map<std::string, macro_core_form_t>::iterator b =
+    HashMap<macro_core_form_t>::iterator b =
         macro_core_forms.find(name);
     if (b == macro_core_forms.end()) {
         return NULL;
@@ -170,7 +171,7 @@ getMacro(const char *name)
 toplevel_core_form_t
 getTopLevel(const char *name)
 {
-    std::map<std::string, toplevel_core_form_t>::iterator b =
+    HashMap<toplevel_core_form_t>::iterator b =
         toplevel_core_forms.find(name);
     if (b == toplevel_core_forms.end()) {
         return NULL;
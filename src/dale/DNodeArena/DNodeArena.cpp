@@ -0,0 +1,222 @@
+#include "DNodeArena.h"
+
+#include "../Utils/Utils.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace dale
+{
+static const size_t DEFAULT_CHUNK_SIZE = 65536;
+static const size_t ALIGNMENT = 8;
+
+DNodeArena::DNodeArena()
+{
+    chunk_used = 0;
+    chunk_size = 0;
+}
+
+DNodeArena::~DNodeArena()
+{
+    for (std::vector<char *>::iterator b = chunks.begin(),
+                                       e = chunks.end();
+            b != e;
+            ++b) {
+        free(*b);
+    }
+}
+
+void *
+DNodeArena::allocate(size_t size)
+{
+    size = (size + (ALIGNMENT - 1)) & ~(ALIGNMENT - 1);
+
+    if ((chunk_used + size) > chunk_size) {
+        size_t new_chunk_size =
+            (size > DEFAULT_CHUNK_SIZE) ? size : DEFAULT_CHUNK_SIZE;
+        char *chunk = (char *) malloc(new_chunk_size);
+        if (!chunk) {
+            error("unable to allocate memory", true);
+        }
+        chunks.push_back(chunk);
+        chunk_used = 0;
+        chunk_size = new_chunk_size;
+    }
+
+    void *memory = chunks.back() + chunk_used;
+    chunk_used += size;
+    return memory;
+}
+
+void
+DNodeArena::addOrigin(Node *node, DNode *dnode)
+{
+    if (dnode->is_list) {
+        list_origins[dnode] = node;
+    } else {
+        atom_origins[dnode->token_str] = node;
+    }
+}
+
+bool
+DNodeArena::matchesNode(DNode *dnode, Node *node)
+{
+    if (dnode->is_list != node->is_list) {
+        return false;
+    }
+    if ((dnode->begin_location != node->getBeginPos()->getLocation())
+            || (dnode->end_location != node->getEndPos()->getLocation())
+            || (dnode->macro_begin_location
+                    != node->macro_begin.getLocation())
+            || (dnode->macro_end_location
+                    != node->macro_end.getLocation())
+            || (dnode->filename != node->filename)) {
+        return false;
+    }
+    if (!dnode->is_list) {
+        /* The token string may have been modified in place. */
+        std::string token_str;
+        node->token->toString(&token_str);
+        if (strcmp(dnode->token_str, token_str.c_str())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+DNodeArena::listIsShallowUnchanged(DNode *dnode, Node *node,
+                                   std::vector<std::pair<DNode *, Node *> >
+                                       *child_lists)
+{
+    if (!matchesNode(dnode, node)) {
+        return false;
+    }
+
+    DNode *current = dnode->list_node;
+    for (std::vector<Node *>::iterator b = node->list->begin(),
+                                       e = node->list->end();
+            b != e;
+            ++b) {
+        Node *child = (*b);
+        if (!current || (!child->is_list && !child->is_token)) {
+            return false;
+        }
+        if (current->is_list) {
+            std::map<DNode *, Node *>::iterator f =
+                list_origins.find(current);
+            if ((f == list_origins.end()) || (f->second != child)) {
+                return false;
+            }
+            child_lists->push_back(std::make_pair(current, child));
+        } else {
+            std::map<const char *, Node *>::iterator f =
+                atom_origins.find(current->token_str);
+            if ((f == atom_origins.end()) || (f->second != child)
+                    || !matchesNode(current, child)) {
+                return false;
+            }
+        }
+        current = current->next_node;
+    }
+
+    return (current == NULL);
+}
+
+bool
+DNodeArena::listIsUnchanged(DNode *dnode, Node *node)
+{
+    /* Each list is checked after all of the lists it contains, so
+     * the lists are first collected in pre-order and then checked in
+     * reverse. */
+    std::vector<std::pair<DNode *, Node *> > pending;
+    std::vector<std::pair<DNode *, Node *> > ordered;
+    pending.push_back(std::make_pair(dnode, node));
+
+    while (!pending.empty()) {
+        std::pair<DNode *, Node *> current = pending.back();
+        pending.pop_back();
+        if (checked_lists.find(current.first) != checked_lists.end()) {
+            continue;
+        }
+        ordered.push_back(current);
+        std::vector<std::pair<DNode *, Node *> > child_lists;
+        if (!listIsShallowUnchanged(current.first, current.second,
+                                    &child_lists)) {
+            checked_lists[current.first] = false;
+            continue;
+        }
+        pending.insert(pending.end(), child_lists.begin(),
+                       child_lists.end());
+    }
+
+    for (std::vector<std::pair<DNode *, Node *> >::reverse_iterator
+            b = ordered.rbegin(), e = ordered.rend();
+            b != e;
+            ++b) {
+        if (checked_lists.find(b->first) != checked_lists.end()) {
+            continue;
+        }
+        std::vector<std::pair<DNode *, Node *> > child_lists;
+        listIsShallowUnchanged(b->first, b->second, &child_lists);
+        bool unchanged = true;
+        for (std::vector<std::pair<DNode *, Node *> >::iterator
+                cb = child_lists.begin(), ce = child_lists.end();
+                cb != ce;
+                ++cb) {
+            if (!checked_lists[cb->first]) {
+                unchanged = false;
+                break;
+            }
+        }
+        checked_lists[b->first] = unchanged;
+    }
+
+    return checked_lists[dnode];
+}
+
+bool
+DNodeArena::claimNode(Node *node)
+{
+    std::vector<Node *> subtree;
+    std::vector<Node *> pending;
+    pending.push_back(node);
+
+    while (!pending.empty()) {
+        Node *current = pending.back();
+        pending.pop_back();
+        if (reused_nodes.find(current) != reused_nodes.end()) {
+            return false;
+        }
+        subtree.push_back(current);
+        if (current->is_list) {
+            pending.insert(pending.end(), current->list->begin(),
+                           current->list->end());
+        }
+    }
+
+    reused_nodes.insert(subtree.begin(), subtree.end());
+    return true;
+}
+
+Node *
+DNodeArena::getOriginalNode(DNode *dnode)
+{
+    if (dnode->is_list) {
+        std::map<DNode *, Node *>::iterator f = list_origins.find(dnode);
+        if ((f != list_origins.end()) && listIsUnchanged(dnode, f->second)
+                && claimNode(f->second)) {
+            return f->second;
+        }
+    } else if (dnode->token_str && dnode->token_str[0]) {
+        std::map<const char *, Node *>::iterator f =
+            atom_origins.find(dnode->token_str);
+        if ((f != atom_origins.end()) && matchesNode(dnode, f->second)
+                && claimNode(f->second)) {
+            return f->second;
+        }
+    }
+    return NULL;
+}
+}
@@ -0,0 +1,87 @@
+#ifndef DALE_DNODEARENA
+#define DALE_DNODEARENA
+
+#include "../Node/Node.h"
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace dale
+{
+/*! DNodeArena
+
+    Provides storage for the DNodes that are passed to a single macro
+    call.  DNodes and token strings are allocated from large chunks,
+    all of which are released when the arena is destroyed, so an
+    arena should last only as long as its macro call.
+
+    The arena also records the node from which each DNode was
+    converted, so that when the macro's result is converted back into
+    nodes, those parts of the result that are unchanged from the
+    arguments can reuse the argument nodes.
+*/
+class DNodeArena
+{
+private:
+    /*! The chunks from which memory is allocated. */
+    std::vector<char *> chunks;
+    /*! The number of bytes used in the last chunk. */
+    size_t chunk_used;
+    /*! The size of the last chunk. */
+    size_t chunk_size;
+    /*! Maps token strings to the atom nodes from which they were
+     *  converted.  Each atom has its own copy of its token string,
+     *  so this also matches copies of argument DNodes. */
+    std::map<const char *, Node *> atom_origins;
+    /*! Maps list DNodes to the list nodes from which they were
+     *  converted. */
+    std::map<DNode *, Node *> list_origins;
+    /*! Records whether a list DNode was found to be unchanged from
+     *  its original node. */
+    std::map<DNode *, bool> checked_lists;
+    /*! The nodes that have already been returned by getOriginalNode,
+     *  along with their descendants. */
+    std::set<Node *> reused_nodes;
+
+    bool matchesNode(DNode *dnode, Node *node);
+    bool listIsShallowUnchanged(DNode *dnode, Node *node,
+                                std::vector<std::pair<DNode *, Node *> >
+                                    *child_lists);
+    bool listIsUnchanged(DNode *dnode, Node *node);
+    bool claimNode(Node *node);
+
+public:
+    DNodeArena();
+    ~DNodeArena();
+
+    /*! Allocate memory from the arena.
+     *  @param size The number of bytes required.
+     *
+     *  The memory is suitably aligned for a DNode.
+     */
+    void *allocate(size_t size);
+    /*! Record the node from which a DNode was converted.
+     *  @param node The node.
+     *  @param dnode The DNode.
+     */
+    void addOrigin(Node *node, DNode *dnode);
+    /*! Get the original node for a DNode, if any.
+     *  @param dnode The DNode.
+     *
+     *  Returns the node from which the DNode was converted, if the
+     *  DNode (or, for an atom, a copy of the DNode) and its
+     *  descendants are unchanged since conversion, and no part of
+     *  that node has already been returned by a previous call.
+     *  Otherwise, returns NULL.  A node is therefore used at most
+     *  once within a macro's result, so that changes made to it in
+     *  place during compilation do not affect other parts of the
+     *  result.
+     */
+    Node *getOriginalNode(DNode *dnode);
+};
+}
+
+#endif
@@ -15,26 +15,25 @@ DNodeConverter::DNodeConverter(ErrorReporter *er)
 static void
 setNodeMacroPosition(Node *node, DNode *dnode)
 {
-    node->macro_begin.setLineAndColumn(dnode->macro_begin_line,
-                                       dnode->macro_begin_column);
-    node->macro_end.setLineAndColumn(dnode->macro_end_line,
-                                     dnode->macro_end_column);
+    node->macro_begin.setLocation(dnode->macro_begin_location);
+    node->macro_end.setLocation(dnode->macro_end_location);
 }
 
 static void
 setNodePosition(Node *node, DNode *dnode)
 {
-    node->list_begin.setLineAndColumn(dnode->begin_line, dnode->begin_column);
-    node->list_end.setLineAndColumn(dnode->end_line, dnode->end_column);
+    node->list_begin.setLocation(dnode->begin_location);
+    node->list_end.setLocation(dnode->end_location);
     setNodeMacroPosition(node, dnode);
 }
 
 static Token *
 dnodeToNullToken(DNode *dnode)
 {
-    return new Token(TokenType::Null,
-                     dnode->begin_line, dnode->begin_column,
-                     dnode->end_line,   dnode->end_column);
+    Token *token = new Token(TokenType::Null);
+    token->begin.setLocation(dnode->begin_location);
+    token->end.setLocation(dnode->end_location);
+    return token;
 }
 
 Node*
@@ -74,14 +73,9 @@ DNodeConverter::stringLiteralAtomToNode(DNode *dnode)
 {
     Token *token = dnodeToNullToken(dnode);
 
-    char str[256];
-    str[0] = '\0';
-
-    strncpy(str, (dnode->token_str) + 1, (strlen(dnode->token_str)-2));
-    str[strlen(dnode->token_str)-2] = '\0';
-
     token->type = TokenType::StringLiteral;
-    token->str_value.append(str);
+    token->str_value.append((dnode->token_str) + 1,
+                            (strlen(dnode->token_str) - 2));
 
     Node *n = new Node(token);
     setNodeMacroPosition(n, dnode);
@@ -131,13 +125,6 @@ DNodeConverter::listToNode(DNode *dnode)
 {
     std::vector<Node *> *list = new std::vector<Node *>;
 
-    DNode *current_node = dnode->list_node;
-    while (current_node) {
-        Node *new_node = toNode(current_node);
-        list->push_back(new_node);
-        current_node = current_node->next_node;
-    }
-
     Node *final_node = new Node(list);
     final_node->filename = dnode->filename;
     setNodePosition(final_node, dnode);
@@ -145,8 +132,48 @@ DNodeConverter::listToNode(DNode *dnode)
 }
 
 Node *
-DNodeConverter::toNode(DNode *dnode)
+DNodeConverter::toNode(DNode *dnode, DNodeArena *arena)
 {
+    bool reused;
+    Node *top_node = toShallowNode(dnode, arena, &reused);
+
+    std::vector<std::pair<DNode *, Node *> > pending;
+    if (top_node && top_node->is_list && !reused) {
+        pending.push_back(std::make_pair(dnode, top_node));
+    }
+
+    while (!pending.empty()) {
+        DNode *list_dnode = pending.back().first;
+        Node *list_node   = pending.back().second;
+        pending.pop_back();
+
+        DNode *current_dnode = list_dnode->list_node;
+        while (current_dnode) {
+            Node *new_node = toShallowNode(current_dnode, arena, &reused);
+            list_node->list->push_back(new_node);
+            if (new_node && new_node->is_list && !reused) {
+                pending.push_back(std::make_pair(current_dnode, new_node));
+            }
+            current_dnode = current_dnode->next_node;
+        }
+    }
+
+    return top_node;
+}
+
+Node *
+DNodeConverter::toShallowNode(DNode *dnode, DNodeArena *arena,
+                              bool *reused)
+{
+    if (arena) {
+        Node *original = arena->getOriginalNode(dnode);
+        if (original) {
+            *reused = true;
+            return original;
+        }
+    }
+    *reused = false;
+
     Node error_node;
     setNodePosition(&error_node, dnode);
     error_node.filename = dnode->filename;
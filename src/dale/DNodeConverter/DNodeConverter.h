@@ -2,6 +2,7 @@
 #define DALE_DNODECONVERTER
 
 #include "../ErrorReporter/ErrorReporter.h"
+#include "../DNodeArena/DNodeArena.h"
 
 namespace dale
 {
@@ -19,6 +20,7 @@ private:
     Node *stringAtomToNode(DNode *dnode);
     Node *atomToNode(DNode *dnode, Node *error_node);
     Node *listToNode(DNode *dnode);
+    Node *toShallowNode(DNode *dnode, DNodeArena *arena, bool *reused);
 
 public:
     /*! Construct a new DNodeConverter.
@@ -27,7 +29,22 @@ public:
      *  This does not take ownership of the error reporter.
      */
     DNodeConverter(ErrorReporter *er);
-    Node *toNode(DNode *dnode);
+    /*! Convert a DNode into a Node.
+     *  @param dnode The DNode.
+     *  @param arena The arena from which argument DNodes were
+     *               allocated (optional).
+     *
+     *  The conversion is iterative, so the depth of the DNode tree is
+     *  limited only by available memory.  If an atom cannot be
+     *  converted, an error is reported, and the atom is represented
+     *  by a null pointer in the resulting list.  If an arena is
+     *  provided, then any part of the DNode tree that is unchanged
+     *  from the node it was converted from is represented by that
+     *  node, rather than by a new node, so the result may share
+     *  nodes with the arguments.  Each such node appears at most
+     *  once in the result.
+     */
+    Node *toNode(DNode *dnode, DNodeArena *arena = NULL);
 };
 }
 
@@ -145,11 +145,9 @@ void Error::setFromNode(Node *node)
     node->getBeginPos()->copyTo(&begin);
     node->getEndPos()->copyTo(&end);
 
-    if (node->macro_begin.getLineNumber()) {
-        macro_begin.setLineAndColumn(node->macro_begin.getLineNumber(),
-                                     node->macro_begin.getColumnNumber());
-        macro_end.setLineAndColumn(node->macro_end.getLineNumber(),
-                                   node->macro_end.getColumnNumber());
+    if (node->macro_begin.isSet()) {
+        node->macro_begin.copyTo(&macro_begin);
+        node->macro_end.copyTo(&macro_end);
     } else {
         macro_begin.zero();
         macro_end.zero();
@@ -168,51 +166,52 @@ void Error::addArgString(const char *str)
 
 void Error::toString(std::string *to)
 {
-    char msg_buf[256];
-    char final_buf[256];
-    char macro_buf[256];
-
     const char *type_string  = errorTypeToString(getType());
     const char *main_err_str = errorInstanceToString(instance);
 
-    if (arg_strings.size() == 0) {
-        sprintf(msg_buf, main_err_str);
-    } else if (arg_strings.size() == 1) {
-        sprintf(msg_buf, main_err_str, arg_strings[0].c_str());
-    } else if (arg_strings.size() == 2) {
-        sprintf(msg_buf, main_err_str, arg_strings[0].c_str(),
-                                       arg_strings[1].c_str());
-    } else if (arg_strings.size() == 3) {
-        sprintf(msg_buf, main_err_str, arg_strings[0].c_str(),
-                                       arg_strings[1].c_str(),
-                                       arg_strings[2].c_str());
-    } else if (arg_strings.size() == 4) {
-        sprintf(msg_buf, main_err_str, arg_strings[0].c_str(),
-                                       arg_strings[1].c_str(),
-                                       arg_strings[2].c_str(),
-                                       arg_strings[3].c_str());
-    } else {
+    if (arg_strings.size() > 4) {
         assert(false && "too many argument strings (>4) in the error");
         abort();
     }
 
-    if (macro_begin.getLineNumber() != 0) {
-        sprintf(macro_buf, " (see macro at %d:%d)",
-                macro_begin.getLineNumber(),
-                macro_begin.getColumnNumber());
-    } else {
-        macro_buf[0] = '\0';
+    int line_number;
+    int column_number;
+    begin.getLineAndColumn(&line_number, &column_number);
+
+    /* The argument strings may be arbitrarily long (e.g. generated
+     * identifiers), so the message is built directly in the output
+     * string.  Only the numeric parts are formatted into buffers. */
+    char number_buf[64];
+    to->append(filename ? filename : "(null)");
+    sprintf(number_buf, ":%d:%d: ", line_number, column_number);
+    to->append(number_buf);
+    to->append(type_string).append(": ");
+
+    /* Error instance strings only use %s conversions. */
+    std::vector<std::string>::iterator arg_iter = arg_strings.begin();
+    for (const char *c = main_err_str; *c; ++c) {
+        if ((*c == '%') && (*(c + 1) == 's')) {
+            if (arg_iter != arg_strings.end()) {
+                to->append(*arg_iter);
+                ++arg_iter;
+            }
+            ++c;
+        } else if ((*c == '%') && (*(c + 1) == '%')) {
+            to->push_back('%');
+            ++c;
+        } else {
+            to->push_back(*c);
+        }
     }
 
-    sprintf(final_buf,
-            "%s:%d:%d: %s: %s%s",
-            filename,
-            begin.getLineNumber(),
-            begin.getColumnNumber(),
-            type_string,
-            msg_buf,
-            macro_buf);
-
-    to->append(final_buf);
+    int macro_line_number;
+    int macro_column_number;
+    macro_begin.getLineAndColumn(&macro_line_number, &macro_column_number);
+    if (macro_line_number != 0) {
+        sprintf(number_buf, " (see macro at %d:%d)",
+                macro_line_number,
+                macro_column_number);
+        to->append(number_buf);
+    }
 }
 }
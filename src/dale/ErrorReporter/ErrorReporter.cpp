@@ -4,6 +4,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cassert>
+#include <algorithm>
 
 namespace dale
 {
@@ -14,6 +15,7 @@ ErrorReporter::ErrorReporter(const char *current_filename)
     }
     this->current_filename = current_filename;
     error_index = 0;
+    std::fill(type_counts, type_counts + ErrorType::Internal + 1, 0);
 }
 
 ErrorReporter::~ErrorReporter()
@@ -33,6 +35,7 @@ ErrorReporter::addError(Error *err)
 {
     setDefaultFilename(err);
     errors.push_back(err);
+    ++type_counts[err->getType()];
 }
 
 void
@@ -65,15 +68,14 @@ ErrorReporter::flush()
 int
 ErrorReporter::getErrorTypeCount(int error_type)
 {
-    int total = 0;
-    for (std::vector<Error *>::iterator b = errors.begin(),
-            e = errors.end(); b != e; ++b) {
-        if ((*b)->getType() == error_type) {
-            ++total;
-        }
-    }
+    return type_counts[error_type];
+}
 
-    return total;
+int
+ErrorReporter::getErrorTypeCountSince(ErrorCheckpoint *cp,
+                                      int error_type)
+{
+    return type_counts[error_type] - cp->type_counts[error_type];
 }
 
 int
@@ -87,6 +89,7 @@ ErrorReporter::popLastError()
 {
     Error *last_error = errors.back();
     errors.pop_back();
+    --type_counts[last_error->getType()];
     return last_error;
 }
 
@@ -99,6 +102,33 @@ ErrorReporter::popErrors(int original_count)
     }
 }
 
+void
+ErrorReporter::setCheckpoint(ErrorCheckpoint *cp)
+{
+    cp->error_count = errors.size();
+    std::copy(type_counts, type_counts + ErrorType::Internal + 1,
+              cp->type_counts);
+}
+
+void
+ErrorReporter::rollback(ErrorCheckpoint *cp,
+                        std::vector<Error *> *removed)
+{
+    assert(cp->error_count <= (int) errors.size());
+
+    if (removed) {
+        removed->insert(removed->end(),
+                        errors.begin() + cp->error_count,
+                        errors.end());
+    }
+    errors.resize(cp->error_count);
+    std::copy(cp->type_counts, cp->type_counts + ErrorType::Internal + 1,
+              type_counts);
+    if (error_index > cp->error_count) {
+        error_index = cp->error_count;
+    }
+}
+
 bool
 ErrorReporter::assertIsIntegerType(const char *form_name,
                                    Node *n, Type *type,
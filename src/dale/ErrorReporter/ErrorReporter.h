@@ -9,12 +9,28 @@
 
 namespace dale
 {
+/*! The state of an ErrorReporter at a given point, for rolling back
+ *  speculative operations. */
+struct ErrorCheckpoint
+{
+    /*! The number of errors present in the reporter. */
+    int error_count;
+    /*! The number of errors of each type present in the reporter. */
+    int type_counts[ErrorType::Internal + 1];
+};
+
 /*! ErrorReporter
 
     The ErrorReporter collects errors and provides various assertion
     methods that generate errors when their conditions are not met.
     It allows for delayed reporting and 'rolling back' to previous
-    states (by way of error counts).
+    states (by way of error counts or checkpoints).  The number of
+    errors of each type is maintained as errors are added and
+    removed, so counting errors and taking and rolling back to
+    checkpoints do not depend on the number of errors present.
+
+    Errors should only be added or removed by way of the methods of
+    this class, so that the counts remain correct.
 */
 class ErrorReporter
 {
@@ -48,6 +64,12 @@ public:
      *  @param error_type The error type (see ErrorType).
      */
     int getErrorTypeCount(int error_type);
+    /*! Get the number of errors of the given type added since the
+     *  checkpoint was set.
+     *  @param cp The checkpoint.
+     *  @param error_type The error type (see ErrorType).
+     */
+    int getErrorTypeCountSince(ErrorCheckpoint *cp, int error_type);
     /*! Get the number of errors present in the reporter.
      */
     int getErrorCount();
@@ -59,6 +81,18 @@ public:
      *  present after the method completes.
      */
     void popErrors(int original_count);
+    /*! Record the current state of the reporter.
+     *  @param cp The checkpoint to set.
+     */
+    void setCheckpoint(ErrorCheckpoint *cp);
+    /*! Remove all errors added since the checkpoint was set.
+     *  @param cp The checkpoint.
+     *  @param removed An optional vector for the removed errors.
+     *
+     *  If removed is provided, then ownership of the removed errors
+     *  is transferred to the caller.
+     */
+    void rollback(ErrorCheckpoint *cp, std::vector<Error *> *removed);
     /*! Print all errors to standard error.
      */
     void flush();
@@ -138,6 +172,10 @@ public:
      */
     bool assertAtomIsSymbol(const char *form_name, Node *n,
                             const char *arg_number);
+
+private:
+    /*! The number of errors of each type in errors. */
+    int type_counts[ErrorType::Internal + 1];
 };
 }
 
@@ -354,6 +354,10 @@ errorInstanceToString(int error_instance)
     case ErrorInst::RetvalsNotPermittedHere:
         ret = "retval types not permitted in this context";
         break;
+    case ErrorInst::EmbedFileRequiresByteArray:
+        ret = "embed-file requires an array of 8-bit integers "
+              "(got %s)";
+        break;
     case ErrorInst::OnlyOneModuleFormPermitted:
         ret = "a 'module' form may only appear once";
         break;
@@ -127,6 +127,7 @@ enum
     SetfOverridesMustReturnBool,
     RefsNotPermittedHere,
     RetvalsNotPermittedHere,
+    EmbedFileRequiresByteArray,
 
     DNodeHasNoString,
     DNodeIsNeitherTokenNorList,
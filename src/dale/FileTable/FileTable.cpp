@@ -0,0 +1,134 @@
+#include "FileTable.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace dale
+{
+namespace FileTable
+{
+static const uint32_t MAX_LOCATION = 0x7FFFFFFF;
+
+/* A contiguous range of locations belonging to a single sequence.
+ * A sequence needs a new chunk whenever another sequence has added
+ * a chunk since it was last extended (e.g. when an included file is
+ * lexed part-way through the including file), or when its line
+ * numbers go backwards. */
+struct Chunk
+{
+    uint32_t base;
+    int sequence;
+    int first_line;
+    int max_column;
+    std::vector<uint32_t> line_starts;
+
+    uint32_t extent() const
+    {
+        return line_starts.back() + max_column + 1;
+    }
+};
+
+static std::vector<Chunk> chunks;
+static std::vector<int> sequence_chunks;
+
+int
+addSequence()
+{
+    sequence_chunks.push_back(-1);
+    return (sequence_chunks.size() - 1);
+}
+
+static Chunk *
+addChunk(int sequence, int line_number)
+{
+    uint32_t base = (chunks.empty() ? 1 : chunks.back().base
+                                          + chunks.back().extent());
+    if (base > MAX_LOCATION) {
+        return NULL;
+    }
+
+    Chunk chunk;
+    chunk.base       = base;
+    chunk.sequence   = sequence;
+    chunk.first_line = line_number;
+    chunk.max_column = 0;
+    chunk.line_starts.push_back(0);
+    chunks.push_back(chunk);
+
+    sequence_chunks[sequence] = chunks.size() - 1;
+    return &(chunks.back());
+}
+
+uint32_t
+getLocation(int sequence, int line_number, int column_number)
+{
+    int chunk_index = sequence_chunks[sequence];
+    Chunk *chunk = NULL;
+    if ((chunk_index != -1)
+            && (chunk_index == ((int) chunks.size() - 1))) {
+        chunk = &(chunks[chunk_index]);
+        int last_line = chunk->first_line + chunk->line_starts.size() - 1;
+        if (line_number < last_line) {
+            chunk = NULL;
+        }
+    }
+    if (!chunk) {
+        chunk = addChunk(sequence, line_number);
+        if (!chunk) {
+            return 0;
+        }
+    }
+
+    while ((chunk->first_line + (int) chunk->line_starts.size() - 1)
+            < line_number) {
+        chunk->line_starts.push_back(chunk->extent());
+        chunk->max_column = 0;
+    }
+    if (column_number > chunk->max_column) {
+        chunk->max_column = column_number;
+    }
+
+    uint64_t location = (uint64_t) chunk->base
+                        + chunk->line_starts.back()
+                        + column_number;
+    if (location > MAX_LOCATION) {
+        return 0;
+    }
+    return (uint32_t) location;
+}
+
+static bool
+chunkBaseLessThan(uint32_t location, const Chunk &chunk)
+{
+    return (location < chunk.base);
+}
+
+bool
+getLineAndColumn(uint32_t location, int *line_number, int *column_number)
+{
+    std::vector<Chunk>::iterator chunk_iter =
+        std::upper_bound(chunks.begin(), chunks.end(), location,
+                         chunkBaseLessThan);
+    if (chunk_iter == chunks.begin()) {
+        return false;
+    }
+    --chunk_iter;
+
+    uint32_t offset = location - chunk_iter->base;
+    if (offset >= chunk_iter->extent()) {
+        return false;
+    }
+
+    std::vector<uint32_t>::iterator line_iter =
+        std::upper_bound(chunk_iter->line_starts.begin(),
+                         chunk_iter->line_starts.end(),
+                         offset);
+    --line_iter;
+
+    *line_number = chunk_iter->first_line
+                   + (line_iter - chunk_iter->line_starts.begin());
+    *column_number = offset - *line_iter;
+    return true;
+}
+}
+}
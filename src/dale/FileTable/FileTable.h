@@ -0,0 +1,50 @@
+#ifndef DALE_FILETABLE
+#define DALE_FILETABLE
+
+#include <stdint.h>
+
+namespace dale
+{
+/*! FileTable
+
+    Maps the line and column numbers of lexed code to and from 32-bit
+    locations.  The table comprises a number of sequences, each of
+    which is a run of lines that is lexed in order (e.g. the contents
+    of a file).  Each line is allotted a range of locations large
+    enough to cover the greatest column number used on that line, so
+    a location can be decoded by searching the table, rather than
+    being stored alongside its line and column numbers.
+
+    Locations are only meaningful for the current compilation.  Zero
+    is never a valid location, and the highest bit of a location is
+    never set (see Position).
+*/
+namespace FileTable
+{
+/*! Add a new sequence to the table.
+ *
+ *  Returns the sequence's index.
+ */
+int addSequence();
+/*! Get the location for a line and column number.
+ *  @param sequence The sequence index.
+ *  @param line_number The line number.
+ *  @param column_number The column number.
+ *
+ *  Line numbers should not decrease between successive calls for the
+ *  same sequence.  Returns zero if the table is full.
+ */
+uint32_t getLocation(int sequence, int line_number, int column_number);
+/*! Get the line and column number for a location.
+ *  @param location The location.
+ *  @param line_number Storage for the line number.
+ *  @param column_number Storage for the column number.
+ *
+ *  Returns false if the location is not in the table.
+ */
+bool getLineAndColumn(uint32_t location, int *line_number,
+                      int *column_number);
+}
+}
+
+#endif
@@ -0,0 +1,125 @@
+#include "EmbedFile.h"
+#include "../../../Error/Error.h"
+#include "../../../llvm_LLVMContext.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace dale::ErrorInst;
+
+namespace dale {
+bool
+FormLiteralEmbedFileIsForm(Node *node)
+{
+    return (node->is_list
+            && (node->list->size() >= 1)
+            && (*node->list)[0]->is_token
+            && !(*node->list)[0]->token->str_value.compare("embed-file"));
+}
+
+llvm::Constant *
+FormLiteralEmbedFileParse(Units *units, Node *node, Type **type)
+{
+    Context *ctx = units->top()->ctx;
+
+    if (!ctx->er->assertArgNums("embed-file", node, 1, 1)) {
+        return NULL;
+    }
+
+    Type *array_type = *type;
+    llvm::Type *llvm_element_type = NULL;
+    if (array_type->is_array) {
+        llvm_element_type =
+            ctx->toLLVMType(array_type->array_type, node, false);
+        if (!llvm_element_type) {
+            return NULL;
+        }
+    }
+    if (!llvm_element_type || !llvm_element_type->isIntegerTy(8)) {
+        std::string type_str;
+        array_type->toString(&type_str);
+        Error *e = new Error(EmbedFileRequiresByteArray, node,
+                             type_str.c_str());
+        ctx->er->addError(e);
+        return NULL;
+    }
+
+    Node *path_node = (*node->list)[1];
+    path_node = units->top()->mp->parsePotentialMacroCall(path_node);
+    if (!path_node) {
+        return NULL;
+    }
+    if (!ctx->er->assertArgIsAtom("embed-file", path_node, "1")) {
+        return NULL;
+    }
+    if (!ctx->er->assertAtomIsStringLiteral("embed-file", path_node, "1")) {
+        return NULL;
+    }
+
+    std::string path_buf;
+    FILE *embed_file =
+        units->mr->openIncludeFile(path_node->token->str_value.c_str(),
+                                   &path_buf, "rb");
+    if (!embed_file) {
+        Error *e = new Error(FileError, path_node, path_buf.c_str(),
+                             strerror(errno));
+        ctx->er->addError(e);
+        return NULL;
+    }
+
+    struct stat file_stat;
+    if (fstat(fileno(embed_file), &file_stat) != 0) {
+        Error *e = new Error(FileError, path_node, path_buf.c_str(),
+                             strerror(errno));
+        ctx->er->addError(e);
+        fclose(embed_file);
+        return NULL;
+    }
+
+    size_t file_size = (size_t) file_stat.st_size;
+    if (file_size == 0) {
+        Error *e = new Error(ZeroLengthGlobalArraysAreUnsupported, node);
+        ctx->er->addError(e);
+        fclose(embed_file);
+        return NULL;
+    }
+    if ((array_type->array_size != 0)
+            && ((size_t) array_type->array_size != file_size)) {
+        Error *e = new Error(IncorrectNumberOfArrayElements, node,
+                             (int) file_size, array_type->array_size);
+        ctx->er->addError(e);
+        fclose(embed_file);
+        return NULL;
+    }
+
+    /* The file is mapped rather than read, so that its contents are
+     * copied only once, when the constant array is created. */
+    void *data = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE,
+                      fileno(embed_file), 0);
+    if (data == MAP_FAILED) {
+        Error *e = new Error(FileError, path_node, path_buf.c_str(),
+                             strerror(errno));
+        ctx->er->addError(e);
+        fclose(embed_file);
+        return NULL;
+    }
+
+    llvm::Constant *init =
+        llvm::ConstantDataArray::get(
+            llvm::getGlobalContext(),
+            llvm::ArrayRef<uint8_t>((const uint8_t *) data, file_size)
+        );
+
+    munmap(data, file_size);
+    fclose(embed_file);
+
+    if (array_type->array_size == 0) {
+        *type = ctx->tr->getArrayType(array_type->array_type, file_size);
+    }
+
+    return init;
+}
+}
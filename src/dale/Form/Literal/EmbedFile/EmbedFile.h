@@ -0,0 +1,28 @@
+#ifndef DALE_FORM_LITERAL_EMBEDFILE
+#define DALE_FORM_LITERAL_EMBEDFILE
+
+#include "../../../Units/Units.h"
+#include "../../../Node/Node.h"
+#include "../../../Type/Type.h"
+
+namespace dale {
+/*! Check whether a node is an embed-file form.
+ *  @param node The node.
+ */
+bool FormLiteralEmbedFileIsForm(Node *node);
+/*! Parse an embed-file form.
+ *  @param units The units context.
+ *  @param node The node containing the embed-file form.
+ *  @param type The type of the variable being initialised.
+ *
+ *  The file is located using the include directory paths, and its
+ *  contents are returned as a single constant array.  The type must
+ *  be an array type with an 8-bit element type: if its size is zero,
+ *  then type will be set to an array type having the size of the
+ *  file, and otherwise the two sizes must be equal.
+ */
+llvm::Constant *FormLiteralEmbedFileParse(Units *units, Node *node,
+                                          Type **type);
+}
+
+#endif
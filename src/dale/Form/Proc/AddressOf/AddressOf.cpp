@@ -129,17 +129,16 @@ FormProcAddressOfParse(Units *units, Function *fn, llvm::BasicBlock *block,
         }
     }
 
-    Type *type = new Type();
-    type->is_function = 1;
-    type->return_type = target_fn->return_type;
-
+    std::vector<Type *> parameter_types;
     for (std::vector<Variable *>::iterator
             b = target_fn->parameters.begin(),
             e = target_fn->parameters.end();
             b != e;
             ++b) {
-        type->parameter_types.push_back((*b)->type);
+        parameter_types.push_back((*b)->type);
     }
+    Type *type = ctx->tr->getFunctionType(target_fn->return_type,
+                                          &parameter_types);
 
     pr->set(block, ctx->tr->getPointerType(type),
             llvm::cast<llvm::Value>(target_fn->llvm_function));
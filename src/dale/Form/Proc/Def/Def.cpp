@@ -136,11 +136,9 @@ storeValue(Context *ctx, Node *node, Type *type,
         return true;
     }
 
-    bool old_const = pr->type->is_const;
-    pr->type->is_const = false;
     bool res = ctx->er->assertTypeEquality("def", node,
-                                           pr->type, type, 1);
-    pr->type->is_const = old_const;
+                                           ctx->tr->getNonConstType(pr->type),
+                                           type, 1);
     if (!res) {
         return false;
     }
@@ -78,14 +78,17 @@ IntNodeToStaticDNode(Units *units, Node *node, llvm::Value *next_node)
     constants.push_back(first);
 
     if (!node->is_list) {
+        /* The token is not modified, since the node may be shared
+         * with other forms. */
         Token *t = node->token;
+        std::string token_str(t->str_value);
         size_t pos = 0;
-        while ((pos = t->str_value.find("\\n", pos)) != std::string::npos) {
-            t->str_value.replace(pos, 2, "\n");
+        while ((pos = token_str.find("\\n", pos)) != std::string::npos) {
+            token_str.replace(pos, 2, "\n");
         }
         if (t->type == TokenType::StringLiteral) {
-            t->str_value.insert(0, "\"");
-            t->str_value.push_back('"');
+            token_str.insert(0, "\"");
+            token_str.push_back('"');
         }
 
         /* If there is an entry in the cache for this string, and
@@ -95,7 +98,7 @@ IntNodeToStaticDNode(Units *units, Node *node, llvm::Value *next_node)
         llvm::GlobalVariable *token_gv = NULL;
 
         std::map<std::string, llvm::GlobalVariable*>::iterator
-            f = token_cache.find(t->str_value);
+            f = token_cache.find(token_str);
         if (f != token_cache.end()) {
             llvm::GlobalVariable *existing_token_gv = f->second;
             if (existing_token_gv->getParent() == units->top()->module) {
@@ -104,7 +107,7 @@ IntNodeToStaticDNode(Units *units, Node *node, llvm::Value *next_node)
         }
 
         if (!token_gv) {
-            token_gv = createTokenGV(units, &(t->str_value));
+            token_gv = createTokenGV(units, &token_str);
         }
 
         llvm::Constant *ptr_to_token =
@@ -139,17 +142,18 @@ IntNodeToStaticDNode(Units *units, Node *node, llvm::Value *next_node)
         constants.push_back(getNullConstant(llvm_r_type));
     }
 
-    int pos[8] = { node->getBeginPos()->getLineNumber(),
-                   node->getBeginPos()->getColumnNumber(),
-                   node->getEndPos()->getLineNumber(),
-                   node->getEndPos()->getColumnNumber(),
-                   node->macro_begin.getLineNumber(),
-                   node->macro_begin.getColumnNumber(),
-                   node->macro_end.getLineNumber(),
-                   node->macro_end.getColumnNumber() };
-    for (int i = 0; i < 8; i++) {
+    /* FileTable locations are only valid for the current
+     * compilation, whereas this node may be used by a later one, so
+     * packed locations are used instead. */
+    uint32_t pos[4] = { node->getBeginPos()->getPackedLocation(),
+                        node->getEndPos()->getPackedLocation(),
+                        node->macro_begin.getPackedLocation(),
+                        node->macro_end.getPackedLocation() };
+    llvm::Type *llvm_uint32_type =
+        ctx->toLLVMType(ctx->tr->type_uint32, NULL, false);
+    for (int i = 0; i < 4; i++) {
         constants.push_back(
-            llvm::cast<llvm::Constant>(ctx->nt->getNativeInt(pos[i]))
+            llvm::ConstantInt::get(llvm_uint32_type, pos[i])
         );
     }
 
@@ -17,6 +17,7 @@
 #include "../../Type/Type.h"
 
 #include <cstdio>
+#include <cstring>
 
 using namespace dale::ErrorInst;
 
@@ -50,17 +51,16 @@ createAnonymousFunction(Units *units, llvm::BasicBlock *block,
         return false;
     }
 
-    Type *fn_type = new Type();
-    fn_type->is_function = 1;
-    fn_type->return_type = anon_fn->return_type;
-
+    std::vector<Type *> parameter_types;
     for (std::vector<Variable *>::iterator
             b = anon_fn->parameters.begin(),
             e = anon_fn->parameters.end();
             b != e;
             ++b) {
-        fn_type->parameter_types.push_back((*b)->type);
+        parameter_types.push_back((*b)->type);
     }
+    Type *fn_type = ctx->tr->getFunctionType(anon_fn->return_type,
+                                             &parameter_types);
 
     pr->set(block, ctx->tr->getPointerType(fn_type),
             llvm::cast<llvm::Value>(anon_fn->llvm_function));
@@ -194,11 +194,8 @@ parsePotentialProcCall(Units *units, Function *fn, llvm::BasicBlock *block,
         if (!mac_node) {
             return false;
         }
-        bool res =
-            FormProcInstParse(units, fn, block, mac_node,
-                              get_address, false, wanted_type, pr);
-        delete mac_node;
-        return res;
+        return FormProcInstParse(units, fn, block, mac_node,
+                                 get_address, false, wanted_type, pr);
     }
 
     int error_count_end = ctx->er->getErrorTypeCount(ErrorType::Error);
@@ -322,11 +319,18 @@ parseInternal(Units *units, Function *fn, llvm::BasicBlock *block,
 
     Node *first = (*lst)[0];
     if (!first->is_token) {
-        (*lst)[0] = units->top()->mp->parsePotentialMacroCall(first);
-        first = (*lst)[0];
-        if (!first) {
+        Node *expanded = units->top()->mp->parsePotentialMacroCall(first);
+        if (!expanded) {
             return false;
         }
+        if (expanded != first) {
+            /* The original node is no longer reachable from the
+             * top-level form, so it is released along with the
+             * form's macro expansions. */
+            units->expansion_nodes.push_back(first);
+            (*lst)[0] = expanded;
+            first = expanded;
+        }
     }
 
     /* If the first node is a token, and it equals "fn", then
@@ -422,6 +426,7 @@ parseInternal(Units *units, Function *fn, llvm::BasicBlock *block,
         lst = but_one;
 
         n = new Node(but_one);
+        units->expansion_nodes.push_back(n);
         first = (*lst)[0];
 
         if (!first->is_token) {
@@ -557,4 +562,300 @@ FormProcInstParse(Units *units, Function *fn, llvm::BasicBlock *block,
 
     return true;
 }
+
+/* The following functions determine the types of particular list
+ * forms without generating code.  Each returns false if the type
+ * cannot be determined in this way, in which case any errors
+ * reported along the way will have been removed. */
+
+bool
+parseArgTypeOnly(Units *units, Node *node, bool get_address, Type **type)
+{
+    Context *ctx = units->top()->ctx;
+
+    ErrorCheckpoint cp;
+    ctx->er->setCheckpoint(&cp);
+
+    *type = NULL;
+    bool res = FormProcInstParseTypeOnly(units, node, get_address, NULL,
+                                         type);
+    if (!res || !*type) {
+        ctx->er->rollback(&cp, NULL);
+        *type = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool
+parseFunctionCallTypeOnly(Units *units, Node *node, Type **type)
+{
+    Context *ctx = units->top()->ctx;
+    std::vector<Node *> *lst = node->list;
+    const char *name = (*lst)[0]->token->str_value.c_str();
+
+    std::vector<Type *> arg_types;
+    for (std::vector<Node *>::iterator b = lst->begin() + 1,
+                                       e = lst->end();
+            b != e;
+            ++b) {
+        Type *arg_type;
+        if (!parseArgTypeOnly(units, (*b), false, &arg_type)) {
+            return false;
+        }
+        if (arg_type->is_array) {
+            return false;
+        }
+        arg_types.push_back(arg_type);
+    }
+
+    Function *fn = ctx->getFunction(name, &arg_types, NULL, 0);
+    if (!fn || fn->is_macro) {
+        return false;
+    }
+
+    /* Reference parameters require lvalue arguments, which cannot be
+     * checked here. */
+    for (std::vector<Variable *>::iterator b = fn->parameters.begin(),
+                                           e = fn->parameters.end();
+            b != e;
+            ++b) {
+        if ((*b)->type->is_reference) {
+            return false;
+        }
+    }
+
+    *type = fn->return_type;
+    return true;
+}
+
+bool
+parseNullPtrTypeOnly(Units *units, Node *node, Type **type)
+{
+    Context *ctx = units->top()->ctx;
+    std::vector<Node *> *lst = node->list;
+
+    if (lst->size() != 2) {
+        return false;
+    }
+
+    *type = NULL;
+    Type *pointee_type = FormTypeParse(units, (*lst)[1], false, false);
+    if (!pointee_type) {
+        return true;
+    }
+    Type *ptr_type = ctx->tr->getPointerType(pointee_type);
+    if (!ctx->toLLVMType(ptr_type, NULL, false, false)) {
+        return true;
+    }
+    *type = ptr_type;
+    return true;
+}
+
+bool
+parseDereferenceTypeOnly(Units *units, Node *node, bool get_address,
+                         Type **type)
+{
+    std::vector<Node *> *lst = node->list;
+
+    if (lst->size() != 2) {
+        return false;
+    }
+
+    Type *ptr_type;
+    if (!parseArgTypeOnly(units, (*lst)[1], false, &ptr_type)) {
+        return false;
+    }
+    if (!ptr_type->points_to
+            || (ptr_type->points_to->base_type == BaseType::Void)) {
+        return false;
+    }
+
+    *type = (get_address) ? ptr_type : ptr_type->points_to;
+    return true;
+}
+
+bool
+parseAddressOfTypeOnly(Units *units, Node *node, Type **type)
+{
+    Context *ctx = units->top()->ctx;
+    std::vector<Node *> *lst = node->list;
+
+    /* Only the variable case is handled here: other lvalues, and
+     * function names, are left to FormProcInstParse. */
+    if ((lst->size() != 2) || !(*lst)[1]->is_token) {
+        return false;
+    }
+    Variable *var =
+        ctx->getVariable((*lst)[1]->token->str_value.c_str());
+    if (!var) {
+        return false;
+    }
+
+    *type = ctx->tr->getPointerType(var->type);
+    return true;
+}
+
+bool
+parseSrefTypeOnly(Units *units, Node *node, Type **type)
+{
+    Context *ctx = units->top()->ctx;
+    std::vector<Node *> *lst = node->list;
+
+    if (lst->size() != 3) {
+        return false;
+    }
+
+    Type *struct_ptr_type;
+    if (!parseArgTypeOnly(units, (*lst)[1], true, &struct_ptr_type)) {
+        return false;
+    }
+    Type *st_type = struct_ptr_type->points_to;
+    if (!st_type
+            || !st_type->struct_name.size()
+            || ctx->getEnum(st_type->struct_name.c_str())) {
+        return false;
+    }
+
+    Node *member_node = (*lst)[2];
+    if (!member_node->is_token
+            || (member_node->token->type != TokenType::String)) {
+        return false;
+    }
+
+    Struct *st = ctx->getStruct(st_type);
+    if (!st) {
+        return false;
+    }
+    int index = st->nameToIndex(member_node->token->str_value.c_str());
+    if (index == -1) {
+        return false;
+    }
+
+    Type *member_type = st->indexToType(index);
+    if (st_type->is_const) {
+        member_type = ctx->tr->getConstType(member_type);
+    }
+    *type = ctx->tr->getPointerType(member_type);
+    return true;
+}
+
+bool
+parseCastTypeOnly(Units *units, Node *node, Type **type)
+{
+    Context *ctx = units->top()->ctx;
+    std::vector<Node *> *lst = node->list;
+
+    if (lst->size() != 3) {
+        return false;
+    }
+
+    Type *from_type;
+    if (!parseArgTypeOnly(units, (*lst)[1], false, &from_type)) {
+        return false;
+    }
+
+    ErrorCheckpoint cp;
+    ctx->er->setCheckpoint(&cp);
+
+    Type *to_type = FormTypeParse(units, (*lst)[2], false, true);
+    if (!to_type
+            || !ctx->toLLVMType(from_type, NULL, false)
+            || !ctx->toLLVMType(to_type, NULL, false)) {
+        ctx->er->rollback(&cp, NULL);
+        return false;
+    }
+
+    if (from_type->isEqualTo(to_type)) {
+        *type = from_type;
+        return true;
+    }
+
+    /* Only the casts that Operation::Cast can always perform are
+     * handled here. */
+    bool from_int  = from_type->isIntegerType();
+    bool to_int    = to_type->isIntegerType();
+    bool from_bool = (from_type->base_type == BaseType::Bool);
+    bool to_bool   = (to_type->base_type == BaseType::Bool);
+    bool from_fp   = from_type->isFloatingPointType();
+    bool to_fp     = to_type->isFloatingPointType();
+    bool from_ptr  = (from_type->points_to != NULL);
+    bool to_ptr    = (to_type->points_to != NULL);
+
+    if ((from_fp && (to_fp || to_int))
+            || (from_int && (to_fp || to_int || to_bool || to_ptr))
+            || (from_bool && to_int)
+            || (from_ptr && (to_ptr || to_int))) {
+        *type = to_type;
+        return true;
+    }
+
+    return false;
+}
+
+bool
+FormProcInstParseTypeOnly(Units *units, Node *node, bool get_address,
+                          Type *wanted_type, Type **type)
+{
+    Context *ctx = units->top()->ctx;
+
+    if (node->is_token) {
+        return FormProcTokenParseTypeOnly(units, node, get_address,
+                                          wanted_type, type);
+    }
+    if (!node->is_list) {
+        return false;
+    }
+
+    std::vector<Node *> *lst = node->list;
+    if (lst->empty()
+            || !(*lst)[0]->is_token
+            || ((*lst)[0]->token->type != TokenType::String)) {
+        return false;
+    }
+
+    /* core-prefixed forms, anonymous functions and literals are left
+     * to FormProcInstParse, as are any forms that may be macro
+     * calls. */
+    const char *name = (*lst)[0]->token->str_value.c_str();
+    if (!strcmp(name, "core")
+            || !strcmp(name, "fn")
+            || !strcmp(name, "array")
+            || ctx->getEnum(name)
+            || ctx->getStruct(name)
+            || ctx->getFunction(name, NULL, NULL, 1)) {
+        return false;
+    }
+
+    /* As per parseInternal, functions take precedence over core
+     * forms that may be overridden. */
+    if (ctx->getFunction(name, NULL, NULL, 0)) {
+        if (get_address) {
+            return false;
+        }
+        return parseFunctionCallTypeOnly(units, node, type);
+    }
+
+    if (!strcmp(name, "@")) {
+        return parseDereferenceTypeOnly(units, node, get_address, type);
+    }
+    if (!strcmp(name, ":")) {
+        /* The result of a struct reference is always an address. */
+        return parseSrefTypeOnly(units, node, type);
+    }
+    if (get_address) {
+        return false;
+    }
+    if (!strcmp(name, "nullptr")) {
+        return parseNullPtrTypeOnly(units, node, type);
+    }
+    if (!strcmp(name, "#")) {
+        return parseAddressOfTypeOnly(units, node, type);
+    }
+    if (!strcmp(name, "cast")) {
+        return parseCastTypeOnly(units, node, type);
+    }
+
+    return false;
+}
 }
@@ -25,6 +25,27 @@ bool
 FormProcInstParse(Units *units, Function *fn, llvm::BasicBlock *block,
                   Node *node, bool get_address, bool prefixed_with_core,
                   Type *wanted_type, ParseResult *pr, bool no_copy = false);
+/*! Determine the type of a procedure-body instruction, without
+ *  generating any code.
+ *  @param units The units context.
+ *  @param node The node being parsed.
+ *  @param get_address Whether to return the address of the result.
+ *  @param wanted_type A preferred response type.
+ *  @param type Storage for the type.
+ *
+ *  This supports atoms, function calls, and the @, #, :, cast and
+ *  nullptr core forms, where their arguments are similarly supported.
+ *  Function calls are resolved against the argument types as per
+ *  FunctionProcessor::parseFunctionCall.  Returns false if the type
+ *  cannot be determined in this way, in which case FormProcInstParse
+ *  must be used instead.  Otherwise, the type is the type that
+ *  FormProcInstParse would report.  If FormProcInstParse would fail,
+ *  then the type is set to NULL, and errors are reported as per
+ *  FormProcInstParse.
+ */
+bool
+FormProcInstParseTypeOnly(Units *units, Node *node, bool get_address,
+                          Type *wanted_type, Type **type);
 }
 
 #endif
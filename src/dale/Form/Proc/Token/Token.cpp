@@ -351,4 +351,91 @@ FormProcTokenParse(Units *units, Function *fn, llvm::BasicBlock *block,
         return false;
     }
 }
+
+bool
+FormProcTokenParseTypeOnly(Units *units, Node *node, bool get_address,
+                           Type *wanted_type, Type **type)
+{
+    Context *ctx = units->top()->ctx;
+
+    Token *t = node->token;
+
+    if (t->type == TokenType::Int) {
+        *type = (wanted_type && wanted_type->isIntegerType())
+                    ? ctx->tr->getBasicType(wanted_type->base_type)
+                    : ctx->tr->type_int;
+        return true;
+    } else if (t->type == TokenType::FloatingPoint) {
+        *type =
+            (wanted_type
+                && wanted_type->base_type == BaseType::Double)
+                ? ctx->tr->type_double
+          : (wanted_type
+                && wanted_type->base_type == BaseType::LongDouble)
+                ? ctx->tr->type_longdouble
+                : ctx->tr->type_float;
+        return true;
+    }
+
+    /* Enum literals are not handled here. */
+    if (wanted_type
+            && (wanted_type->struct_name.size())
+            && ctx->getEnum(wanted_type->struct_name.c_str())) {
+        return false;
+    }
+
+    if (t->type == TokenType::String) {
+        if (!t->str_value.compare("true")
+                || !t->str_value.compare("false")) {
+            *type = ctx->tr->type_bool;
+            return true;
+        }
+
+        if ((t->str_value.size() >= 3)
+                && (t->str_value[0] == '#')
+                && (t->str_value[1] == '\\')) {
+            const char *value = t->str_value.c_str() + 2;
+            if (!strcmp(value, "NULL")
+                    || !strcmp(value, "TAB")
+                    || !strcmp(value, "SPACE")
+                    || !strcmp(value, "NEWLINE")
+                    || !strcmp(value, "CARRIAGE")
+                    || !strcmp(value, "EOF")
+                    || (strlen(value) == 1)) {
+                *type = ctx->tr->type_char;
+                return true;
+            }
+            /* Invalid character literals lead to two errors, so
+             * leave them to FormProcTokenParse. */
+            return false;
+        }
+
+        Variable *var = ctx->getVariable(t->str_value.c_str());
+        if (!var) {
+            Error *e = new Error(VariableNotInScope, node,
+                                 t->str_value.c_str());
+            ctx->er->addError(e);
+            *type = NULL;
+            return true;
+        }
+
+        *type = (get_address)
+                    ? ctx->tr->getPointerType(var->type)
+              : (var->type->is_array)
+                    ? ctx->tr->getPointerType(var->type->array_type)
+                    : var->type;
+        return true;
+    } else if (t->type == TokenType::StringLiteral) {
+        *type =
+            ctx->tr->getPointerType(
+                ctx->tr->getConstType(ctx->tr->type_char)
+            );
+        return true;
+    } else {
+        Error *e = new Error(UnableToParseForm, node);
+        ctx->er->addError(e);
+        *type = NULL;
+        return true;
+    }
+}
 }
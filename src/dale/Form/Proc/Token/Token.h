@@ -24,6 +24,23 @@ namespace dale
 bool FormProcTokenParse(Units *units, Function *fn, llvm::BasicBlock *block,
                         Node *node, bool get_address, bool prefixed_with_core,
                         Type *wanted_type, ParseResult *pr);
+/*! Determine the type of a procedure-body token, without generating
+ *  any code.
+ *  @param units The units context.
+ *  @param node The node being parsed.
+ *  @param get_address Whether to return the address of the result.
+ *  @param wanted_type A preferred response type.
+ *  @param type Storage for the type.
+ *
+ *  Returns false if the type cannot be determined in this way, in
+ *  which case FormProcTokenParse must be used instead.  Otherwise,
+ *  the type is the type that FormProcTokenParse would report.  If
+ *  FormProcTokenParse would fail, then the type is set to NULL, and
+ *  the same error is reported.
+ */
+bool FormProcTokenParseTypeOnly(Units *units, Node *node,
+                                bool get_address, Type *wanted_type,
+                                Type **type);
 }
 
 #endif
@@ -198,6 +198,11 @@ FormStructParse(Units *units, Node *top, const char *name)
         delete (*b);
     }
 
+    /* Completing the struct changes the result of probes that
+     * depend on it, such as has-errors on a form that instantiates
+     * it. */
+    Namespace::struct_changes.add(name);
+
     return true;
 }
 }
@@ -204,9 +204,22 @@ FormTopLevelEnumParse(Units *units, Node *node)
         return false;
     }
 
-    Type *final_enum_type = new Type();
-    final_enum_type->struct_name = name;
-    ctx->setNamespacesForEnum(name, &(final_enum_type->namespaces));
+    /* The enum's struct was added to the current namespace, so its
+     * name is qualified from there, rather than by way of the used
+     * namespaces, one of which may have a struct with the same
+     * name. */
+    std::vector<std::string> namespaces;
+    ctx->ns()->setNamespaces(&namespaces);
+    std::string qualified_name;
+    for (std::vector<std::string>::iterator b = namespaces.begin(),
+                                            e = namespaces.end();
+            b != e;
+            ++b) {
+        qualified_name.append(*b);
+        qualified_name.append(".");
+    }
+    qualified_name.append(name);
+    Type *final_enum_type = ctx->tr->getStructType(qualified_name.c_str());
 
     int final_linkage =
         (linkage == EnumLinkage::Extern)
@@ -6,6 +6,7 @@
 #include "../../../Operation/Sizeof/Sizeof.h"
 #include "../../../Operation/Offsetof/Offsetof.h"
 #include "../../Linkage/Linkage.h"
+#include "../../Literal/EmbedFile/EmbedFile.h"
 #include "../../ProcBody/ProcBody.h"
 #include "../../Type/Type.h"
 #include "Config.h"
@@ -138,13 +139,12 @@ parseLiteralStruct(Units *units, Node *top, char *data, Type *type,
         }
         total_padding += padding;
 
-        assert((member_size <= 256) && "struct member size too large");
         char *addr = data + offset;
-        char aligned[256];
-        memcpy(aligned, addr, member_size);
+        std::vector<char> aligned(member_size + 1);
+        memcpy(&aligned[0], addr, member_size);
 
         llvm::Constant *member_value =
-            parseLiteralElement(units, top, (char*) aligned, member_type, size);
+            parseLiteralElement(units, top, &aligned[0], member_type, size);
         if (!member_value) {
             return NULL;
         }
@@ -235,15 +235,13 @@ parseLiteralArray(Units *units, Node *top, char *data, Type *type,
     Context *ctx = units->top()->ctx;
 
     size_t member_size = Operation::SizeofGet(units->top(), type->array_type);
-    assert((member_size <= 256) && "array member size too large");
     int members = type->array_size;
     std::vector<llvm::Constant *> constants;
 
-    char mem_array[256];
-    char *mem = mem_array;
+    std::vector<char> mem_array(member_size + 1);
+    char *mem = &mem_array[0];
 
     for (int i = 0; i < members; i++) {
-        memset(mem, 0, 256);
         char *member_ptr = ((char*) data) + (i * member_size);
         memcpy(mem, member_ptr, member_size);
 
@@ -316,6 +314,39 @@ parseLiteralElement(Units *units, Node *top, char *data, Type *type,
     return NULL;
 }
 
+/* If the function consists of a single block that returns a scalar
+ * constant, and has no side effects, return that constant. */
+static llvm::Constant *
+getReturnedConstant(llvm::Function *llvm_fn)
+{
+    if (llvm_fn->size() != 1) {
+        return NULL;
+    }
+    llvm::BasicBlock *block = &(llvm_fn->front());
+    for (llvm::BasicBlock::iterator b = block->begin(),
+                                    e = block->end();
+            b != e;
+            ++b) {
+        if (b->mayHaveSideEffects()) {
+            return NULL;
+        }
+    }
+    llvm::ReturnInst *ret =
+        llvm::dyn_cast_or_null<llvm::ReturnInst>(block->getTerminator());
+    if (!ret) {
+        return NULL;
+    }
+    llvm::Value *value = ret->getReturnValue();
+    if (!value) {
+        return NULL;
+    }
+    if (!llvm::isa<llvm::ConstantInt>(value)
+            && !llvm::isa<llvm::ConstantFP>(value)) {
+        return NULL;
+    }
+    return llvm::cast<llvm::Constant>(value);
+}
+
 llvm::Constant *
 parseLiteral(Units *units, Type *type, Node *top, int *size)
 {
@@ -398,6 +429,23 @@ parseLiteral(Units *units, Type *type, Node *top, int *size)
         return NULL;
     }
 
+    std::vector<Type *> call_arg_types;
+    Type *ptr_type = ctx->tr->getPointerType(type);
+    STL::push_back2(&call_arg_types, ptr_type, ptr_type);
+
+    Function *or_setf =
+        ctx->getFunction("setf-assign", &call_arg_types, NULL, 0);
+
+    /* Most initialisers are simple constants, in which case there is
+     * no need to compile and run the function. */
+    if (!or_setf) {
+        llvm::Constant *returned = getReturnedConstant(llvm_fn);
+        if (returned) {
+            llvm_fn->eraseFromParent();
+            return returned;
+        }
+    }
+
     llvm::Type *llvm_type_void =
         ctx->toLLVMType(ctx->tr->type_void, NULL, true);
     llvm::FunctionType *wrapper_ft =
@@ -426,12 +474,7 @@ parseLiteral(Units *units, Type *type, Node *top, int *size)
     llvm::Value *ret_storage2 = builder.CreateAlloca(llvm_return_type);
     builder.CreateStore(ret, ret_storage2);
 
-    std::vector<Type *> call_arg_types;
-    Type *ptr_type = ctx->tr->getPointerType(type);
-    STL::push_back2(&call_arg_types, ptr_type, ptr_type);
-
-    if (Function *or_setf =
-            ctx->getFunction("setf-assign", &call_arg_types, NULL, 0)) {
+    if (or_setf) {
         std::vector<llvm::Value *> or_call_args;
         STL::push_back2(&or_call_args, ret_storage1, ret_storage2);
         builder.CreateCall(
@@ -452,11 +495,14 @@ parseLiteral(Units *units, Type *type, Node *top, int *size)
     block = cast_pr.block;
     llvm::Value *ret_cast = cast_pr.value;
 
-    char data[256];
-    memset(data, 0, 256);
+    /* The buffer is sized for the type, so that large aggregate
+     * initialisers can be evaluated. */
+    size_t struct_size = Operation::SizeofGet(units->top(), type);
+    std::vector<char> data_buffer(struct_size + 1, 0);
+    char *data = &data_buffer[0];
 
     char ptr_int[64];
-    sprintf(ptr_int, "%lld", (long long int) &data);
+    sprintf(ptr_int, "%lld", (long long int) data);
 
     llvm::Value *ptr_value =
         ctx->nt->getConstantInt(
@@ -476,8 +522,7 @@ parseLiteral(Units *units, Type *type, Node *top, int *size)
     Function *memcpy = ctx->getFunction("memcpy", NULL, NULL, 0);
     assert(memcpy && "no memcpy function available");
 
-    size_t struct_size = Operation::SizeofGet(units->top(), type);
-    char struct_size_str[8];
+    char struct_size_str[32];
     sprintf(struct_size_str, "%u", (unsigned) struct_size);
 
     std::vector<llvm::Value*> memcpy_args;
@@ -501,7 +546,7 @@ parseLiteral(Units *units, Type *type, Node *top, int *size)
     ((void (*)()) fptr)();
 
     llvm::Constant *parsed =
-        parseLiteralElement(units, top, (char*) &data, type, size);
+        parseLiteralElement(units, top, data, type, size);
 
     wrapper_fn->eraseFromParent();
     (llvm::cast<llvm::Function>(const_fn))->eraseFromParent();
@@ -582,11 +627,6 @@ FormTopLevelGlobalVariableParse(Units *units, Node *node)
     if (ret_type == NULL) {
         return false;
     }
-    if (ret_type->array_type && (ret_type->array_size == 0)) {
-        Error *e = new Error(ZeroLengthGlobalArraysAreUnsupported, def_node);
-        ctx->er->addError(e);
-        return false;
-    }
 
     if (has_initialiser) {
         value_node = units->top()->mp->parsePotentialMacroCall(value_node);
@@ -595,9 +635,25 @@ FormTopLevelGlobalVariableParse(Units *units, Node *node)
         }
     }
 
+    /* An embed-file initialiser determines the size of the array
+     * when none is given, so it is handled before the check for
+     * zero-length arrays. */
     int size = 0;
     llvm::Constant *init = NULL;
-    if (has_initialiser) {
+    if (has_initialiser && FormLiteralEmbedFileIsForm(value_node)) {
+        init = FormLiteralEmbedFileParse(units, value_node, &ret_type);
+        if (!init) {
+            return false;
+        }
+    }
+
+    if (ret_type->array_type && (ret_type->array_size == 0)) {
+        Error *e = new Error(ZeroLengthGlobalArraysAreUnsupported, def_node);
+        ctx->er->addError(e);
+        return false;
+    }
+
+    if (has_initialiser && !init) {
         init = parseLiteral(units, ret_type, value_node, &size);
         if (!init) {
             return false;
@@ -34,20 +34,9 @@ FormTopLevelIncludeParse(Units *units, Node *node)
 
     std::string path_buf;
 
-    FILE *include_file = NULL;
-    for (std::vector<const char *>::iterator
-                b = units->mr->include_directory_paths.begin(),
-                e = units->mr->include_directory_paths.end();
-            b != e;
-            ++b) {
-        path_buf.clear();
-        path_buf.append((*b));
-        path_buf.append(path_node->token->str_value.c_str());
-        include_file = fopen(path_buf.c_str(), "r");
-        if (include_file) {
-            break;
-        }
-    }
+    FILE *include_file =
+        units->mr->openIncludeFile(path_node->token->str_value.c_str(),
+                                   &path_buf, "r");
 
     if (!include_file) {
         Error *e = new Error(FileError, path_node, path_buf.c_str(),
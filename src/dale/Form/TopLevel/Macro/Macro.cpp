@@ -16,10 +16,11 @@ namespace dale
 void
 removeMacro(Context *ctx, const char *name)
 {
-    std::map<std::string, std::vector<Function*>*>::iterator b =
+    HashMap<std::vector<Function *> *>::iterator b =
         ctx->ns()->functions.find(name);
 
     if (b != ctx->ns()->functions.end()) {
+        ctx->ns()->clearFunctionLookups(b->first);
         for (std::vector<Function *>::iterator j = b->second->begin(),
                                                k = b->second->end();
                 j != k;
@@ -32,6 +33,30 @@ removeMacro(Context *ctx, const char *name)
     }
 }
 
+static bool
+parseMacroAttributes(Context *ctx, std::vector<Node *> *attr_list,
+                     bool *is_pure)
+{
+    for (std::vector<Node*>::iterator b = (attr_list->begin() + 1),
+                                      e = attr_list->end();
+            b != e;
+            ++b) {
+        if ((*b)->is_list) {
+            Error *e = new Error(InvalidAttribute, (*b));
+            ctx->er->addError(e);
+            return false;
+        }
+        if (!((*b)->token->str_value.compare("pure"))) {
+            *is_pure = true;
+        } else {
+            Error *e = new Error(InvalidAttribute, (*b));
+            ctx->er->addError(e);
+            return false;
+        }
+    }
+    return true;
+}
+
 bool
 FormTopLevelMacroParse(Units *units, Node *node)
 {
@@ -54,14 +79,36 @@ FormTopLevelMacroParse(Units *units, Node *node)
         return false;
     }
 
-    int linkage = FormLinkageParse(ctx, (*lst)[1]);
+    int next_index = 1;
+    bool is_pure = false;
+
+    Node *test = (*lst)[next_index];
+    if (test->is_list
+            && (test->list->size() > 0)
+            && (*test->list)[0]->is_token
+            && !((*test->list)[0]->token->str_value.compare("attr"))) {
+        if (!parseMacroAttributes(ctx, test->list, &is_pure)) {
+            return false;
+        }
+        ++next_index;
+        if (lst->size() < 4) {
+            Error *e = new Error(IncorrectMinimumNumberOfArgs, top,
+                                 "macro", 3, (int) (lst->size() - 1));
+            ctx->er->addError(e);
+            return false;
+        }
+    }
+
+    int linkage = FormLinkageParse(ctx, (*lst)[next_index]);
     if (!linkage) {
         return false;
     }
+    ++next_index;
 
     Type *ret_type = ctx->tr->type_pdnode;
 
-    Node *macro_params = (*lst)[2];
+    Node *macro_params = (*lst)[next_index];
+    ++next_index;
     if (!macro_params->is_list) {
         Error *e = new Error(UnexpectedElement, macro_params,
                              "list", "macro parameters", "atom");
@@ -183,6 +230,7 @@ FormTopLevelMacroParse(Units *units, Node *node)
     Function *fn = new Function(ret_type, &mc_params_internal, llvm_fn,
                                 true, &new_name);
     fn->linkage = linkage;
+    fn->is_pure = is_pure;
 
     if (!ctx->ns()->addFunction(name, fn, top)) {
         return false;
@@ -191,8 +239,9 @@ FormTopLevelMacroParse(Units *units, Node *node)
         fn->once_tag = units->top()->once_tag;
     }
 
-    /* If the list has only three arguments, the macro is a declaration. */
-    if (lst->size() == 3) {
+    /* If the list has no elements after the parameters, the macro is
+     * a declaration. */
+    if ((int) lst->size() == next_index) {
         return true;
     }
 
@@ -201,7 +250,7 @@ FormTopLevelMacroParse(Units *units, Node *node)
     ctx->activateAnonymousNamespace();
     std::string anon_name = ctx->ns()->name;
     units->top()->pushGlobalFunction(fn);
-    FormProcBodyParse(units, top, fn, llvm_fn, 3, 0);
+    FormProcBodyParse(units, top, fn, llvm_fn, next_index, 0);
     units->top()->popGlobalFunction();
     ctx->deactivateNamespace(anon_name.c_str());
 
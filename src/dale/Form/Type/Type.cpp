@@ -328,12 +328,7 @@ FormTypeParse(Units *units, Node *node, bool allow_anon_structs,
             parameter_types.push_back(var->type);
         }
 
-        Type *type = new Type();
-        type->is_function = true;
-        type->return_type = ret_type;
-        type->parameter_types = parameter_types;
-
-        return type;
+        return ctx->tr->getFunctionType(ret_type, &parameter_types);
     }
 
     Error *e = new Error(InvalidType, node);
@@ -1,6 +1,7 @@
 #include "Function.h"
 
 #include "../STL/STL.h"
+#include "../UndoLog/UndoLog.h"
 
 namespace dale
 {
@@ -9,9 +10,13 @@ Function::Function()
     is_macro      = false;
     always_inline = false;
     cto           = false;
+    is_pure       = false;
     is_destructor = false;
     is_setf_fn    = false;
     serialise     = true;
+
+    macro_fptr               = NULL;
+    macro_fptr_llvm_function = NULL;
 }
 
 Function::Function(
@@ -30,9 +35,13 @@ Function::Function(
     this->always_inline   = always_inline;
 
     cto           = false;
+    is_pure       = false;
     is_destructor = false;
     is_setf_fn    = false;
     serialise     = true;
+
+    macro_fptr               = NULL;
+    macro_fptr_llvm_function = NULL;
 }
 
 Function::~Function()
@@ -55,7 +64,11 @@ Function::getLabel(const char *name)
 bool
 Function::addLabel(const char *name, Label *label)
 {
-    labels.insert(std::pair<std::string, Label *>(name, label));
+    bool inserted =
+        labels.insert(std::pair<std::string, Label *>(name, label)).second;
+    if (inserted) {
+        UndoLog::addLabelChange(this, name);
+    }
     return true;
 }
 
@@ -37,6 +37,10 @@ public:
     bool always_inline;
     /*! Whether the function is actually a macro. */
     bool is_macro;
+    /*! For macros, whether the macro is pure: that is, whether its
+     *  expansion depends only on its arguments, such that the
+     *  expansion may be cached and reused. */
+    bool is_pure;
     /*! Whether the function is for use only during compile time. */
     bool cto;
     /*! Whether the function is a destructor. */
@@ -50,6 +54,16 @@ public:
     /*! The function's index.  This is set by Namespace on function
      *  insertion. */
     int index;
+    /*! For macros, a cached pointer to the macro's compiled code.
+     *  This is set by MacroProcessor on the first call. */
+    void *macro_fptr;
+    /*! The LLVM function from which macro_fptr was taken.  If this
+     *  differs from llvm_function, macro_fptr must be refetched. */
+    llvm::Function *macro_fptr_llvm_function;
+    /*! The key under which the macro's compiled code is shared with
+     *  other, identical macros.  This is set by MacroProcessor on the
+     *  first call, and is empty if the code may not be shared. */
+    std::string macro_code_key;
 
     Function();
     /*! Construct a new function using the given parameters.
@@ -253,19 +253,11 @@ isUnoverloadedMacro(Units *units, const char *name,
                     std::vector<Node*> *lst,
                     Function **macro_to_call)
 {
-    std::map<std::string, std::vector<Function *> *>::iterator
-        iter;
     Function *fn = NULL;
-    for (std::vector<NSNode *>::reverse_iterator
-            rb = units->top()->ctx->used_ns_nodes.rbegin(),
-            re = units->top()->ctx->used_ns_nodes.rend();
-            rb != re;
-            ++rb) {
-        iter = (*rb)->ns->functions.find(name);
-        if (iter != (*rb)->ns->functions.end()) {
-            fn = (*iter->second)[0];
-            break;
-        }
+    std::vector<Namespace *> *nss =
+        units->top()->ctx->getVisibleFunctionNamespaces(name);
+    if (!nss->empty()) {
+        fn = (*nss->front()->functions.find(name)->second)[0];
     }
     if (fn && fn->is_macro) {
         /* If the third argument is either non-existent, or a (p
@@ -544,13 +536,14 @@ FunctionProcessor::parseFunctionCall(Function *dfn, llvm::BasicBlock *block,
             b != e;
             ++b) {
         call_arg_nodes.push_back(*b);
-        int error_count = er->getErrorTypeCount(ErrorType::Error);
+        ErrorCheckpoint cp;
+        er->setCheckpoint(&cp);
 
         ParseResult arg_pr;
         bool res = FormProcInstParse(units, dfn, block, (*b),
                                      false, false, NULL, &arg_pr, true);
 
-        int diff = er->getErrorTypeCount(ErrorType::Error) - error_count;
+        int diff = er->getErrorTypeCountSince(&cp, ErrorType::Error);
 
         if (!res || diff) {
             /* May be a macro call (could be an unparseable
@@ -558,13 +551,7 @@ FunctionProcessor::parseFunctionCall(Function *dfn, llvm::BasicBlock *block,
              * and treat this argument as a (p DNode). */
 
             if (diff) {
-                errors.insert(errors.end(),
-                              er->errors.begin() + error_count,
-                              er->errors.end());
-                er->errors.erase(
-                    er->errors.begin() + error_count,
-                    er->errors.end()
-                );
+                er->rollback(&cp, &errors);
             }
 
             call_args.push_back(NULL);
@@ -74,6 +74,7 @@
 #include "../Unit/Unit.h"
 #include "../CoreForms/CoreForms.h"
 #include "../CommonDecl/CommonDecl.h"
+#include "../InstantiationMap/InstantiationMap.h"
 
 static const char *x86_64_layout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128";
 static const char *x86_32_layout = "e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:32:64-f32:32:32-f64:32:64-v64:64:64-v128:128:128-a0:0:64-f80:32:32";
@@ -374,16 +375,13 @@ Generator::run(std::vector<const char *> *file_paths,
             }
         }
 
-        std::vector<Node*> nodes;
         for (;;) {
             int error_count = er.getErrorTypeCount(ErrorType::Error);
             Node *top = units.top()->parser->getNextList();
-            if (top) {
-                nodes.push_back(top);
-            }
 
             if (er.getErrorTypeCount(ErrorType::Error) > error_count) {
                 er.flush();
+                units.releaseNodes(top);
                 continue;
             }
             if (!top) {
@@ -392,6 +390,7 @@ Generator::run(std::vector<const char *> *file_paths,
             }
 
             if (!top->is_token && !top->is_list) {
+                units.releaseNodes(top);
                 units.pop();
                 if (!units.empty()) {
                     Unit *unit = units.top();
@@ -403,7 +402,13 @@ Generator::run(std::vector<const char *> *file_paths,
                 break;
             }
             FormTopLevelInstParse(&units, top);
+            if (er.getErrorTypeCount(ErrorType::Error) > error_count) {
+                discardPendingInstantiations(0);
+            } else {
+                commitPendingInstantiations();
+            }
             er.flush();
+            units.releaseNodes(top);
         }
 
         if (remove_macros) {
@@ -419,13 +424,6 @@ Generator::run(std::vector<const char *> *file_paths,
         }
 
         last_module = mod;
-
-        for (std::vector<Node *>::iterator b = nodes.begin(),
-                                           e = nodes.end();
-                b != e;
-                ++b) {
-            delete (*b);
-        }
     }
 
     if (remove_macros) {
@@ -515,6 +513,7 @@ Generator::run(std::vector<const char *> *file_paths,
                 e = static_dtm_modules.end();
                 b != e; ++b) {
             if (cto_modules.find(b->first) == cto_modules.end()) {
+                mr.materializeModule(b->second);
                 linkModule(linker, b->second);
             }
         }
@@ -526,6 +525,7 @@ Generator::run(std::vector<const char *> *file_paths,
             std::map<std::string, llvm::Module *>::iterator
             found = static_dtm_modules.find(std::string(*b));
             if (found != static_dtm_modules.end()) {
+                mr.materializeModule(found->second);
                 linkModule(linker, found->second);
             }
         }
@@ -0,0 +1,279 @@
+#ifndef DALE_HASHMAP
+#define DALE_HASHMAP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+namespace dale
+{
+/*! HashMap
+
+    An open-addressing hash table with string keys, for use as a
+    symbol table.  The interface is the subset of std::map's interface
+    that is used by the compiler: iterators dereference to a
+    std::pair, whose first member is the key and whose second member
+    is the value.
+
+    Erasing an element leaves a marker in its slot, so erasing does
+    not invalidate iterators to other elements.  Inserting may cause
+    the table to be rebuilt, which invalidates all iterators.
+    Iteration order is deterministic for a given sequence of
+    insertions and erasures, but it is not sorted.
+*/
+template <typename V>
+class HashMap
+{
+public:
+    typedef std::pair<std::string, V> value_type;
+
+private:
+    enum { Empty, Full, Erased };
+
+    struct Slot
+    {
+        int state;
+        size_t hash;
+        value_type entry;
+
+        Slot() : state(Empty), hash(0) {}
+    };
+
+    std::vector<Slot> slots;
+    size_t full_count;
+    size_t erased_count;
+
+    static size_t
+    hashKey(const std::string &key)
+    {
+        /* FNV-1a. */
+        size_t hash = 2166136261U;
+        for (std::string::const_iterator b = key.begin(),
+                                         e = key.end();
+                b != e;
+                ++b) {
+            hash ^= (unsigned char) (*b);
+            hash *= 16777619U;
+        }
+        return hash;
+    }
+
+    /* Returns the index of the slot containing the key, or the
+     * number of slots if the key is not present. */
+    size_t
+    findIndex(const std::string &key, size_t hash) const
+    {
+        size_t capacity = slots.size();
+        if (!capacity) {
+            return 0;
+        }
+        size_t mask = capacity - 1;
+        size_t index = hash & mask;
+        for (size_t step = 1; step <= capacity; ++step) {
+            const Slot &slot = slots[index];
+            if (slot.state == Empty) {
+                return capacity;
+            }
+            if ((slot.state == Full) && (slot.hash == hash)
+                    && (slot.entry.first == key)) {
+                return index;
+            }
+            index = (index + step) & mask;
+        }
+        return capacity;
+    }
+
+    void
+    rebuild(size_t capacity)
+    {
+        std::vector<Slot> old_slots(capacity);
+        old_slots.swap(slots);
+        full_count   = 0;
+        erased_count = 0;
+        for (typename std::vector<Slot>::iterator b = old_slots.begin(),
+                                                  e = old_slots.end();
+                b != e;
+                ++b) {
+            if (b->state == Full) {
+                insertNew(b->entry, b->hash);
+            }
+        }
+    }
+
+    /* Inserts an entry whose key is known not to be present, and
+     * returns its index. */
+    size_t
+    insertNew(const value_type &entry, size_t hash)
+    {
+        size_t capacity = slots.size();
+        if (((full_count + erased_count + 1) * 4) > (capacity * 3)) {
+            size_t new_capacity = (capacity ? capacity : 8);
+            while (((full_count + 1) * 2) > new_capacity) {
+                new_capacity *= 2;
+            }
+            rebuild(new_capacity);
+            capacity = new_capacity;
+        }
+        size_t mask = capacity - 1;
+        size_t index = hash & mask;
+        for (size_t step = 1; slots[index].state == Full; ++step) {
+            index = (index + step) & mask;
+        }
+        Slot &slot = slots[index];
+        if (slot.state == Erased) {
+            --erased_count;
+        }
+        slot.state = Full;
+        slot.hash  = hash;
+        slot.entry = entry;
+        ++full_count;
+        return index;
+    }
+
+public:
+    class iterator
+    {
+        friend class HashMap;
+
+        std::vector<Slot> *slots;
+        size_t index;
+
+        iterator(std::vector<Slot> *slots, size_t index) :
+            slots(slots), index(index)
+        {
+            skip();
+        }
+
+        void
+        skip()
+        {
+            while ((index < slots->size())
+                    && ((*slots)[index].state != Full)) {
+                ++index;
+            }
+        }
+
+    public:
+        iterator() : slots(NULL), index(0) {}
+
+        value_type &operator*() const { return (*slots)[index].entry; }
+        value_type *operator->() const { return &((*slots)[index].entry); }
+
+        iterator &
+        operator++()
+        {
+            ++index;
+            skip();
+            return *this;
+        }
+
+        iterator
+        operator++(int)
+        {
+            iterator previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        bool
+        operator==(const iterator &other) const
+        {
+            return (index == other.index);
+        }
+
+        bool
+        operator!=(const iterator &other) const
+        {
+            return (index != other.index);
+        }
+    };
+
+    HashMap() : full_count(0), erased_count(0) {}
+
+    iterator begin() { return iterator(&slots, 0); }
+    iterator end()   { return iterator(&slots, slots.size()); }
+
+    size_t size() const { return full_count; }
+    bool empty() const { return (full_count == 0); }
+
+    iterator
+    find(const std::string &key)
+    {
+        return iterator(&slots, findIndex(key, hashKey(key)));
+    }
+
+    size_t
+    count(const std::string &key) const
+    {
+        return (findIndex(key, hashKey(key)) != slots.size()) ? 1 : 0;
+    }
+
+    std::pair<iterator, bool>
+    insert(const value_type &entry)
+    {
+        size_t hash = hashKey(entry.first);
+        size_t index = findIndex(entry.first, hash);
+        if (index != slots.size()) {
+            return std::make_pair(iterator(&slots, index), false);
+        }
+        index = insertNew(entry, hash);
+        return std::make_pair(iterator(&slots, index), true);
+    }
+
+    V &
+    operator[](const std::string &key)
+    {
+        size_t hash = hashKey(key);
+        size_t index = findIndex(key, hash);
+        if (index == slots.size()) {
+            index = insertNew(value_type(key, V()), hash);
+        }
+        return slots[index].entry.second;
+    }
+
+    void
+    erase(iterator iter)
+    {
+        Slot &slot = slots[iter.index];
+        slot.state = Erased;
+        slot.entry = value_type();
+        --full_count;
+        ++erased_count;
+    }
+
+    size_t
+    erase(const std::string &key)
+    {
+        size_t index = findIndex(key, hashKey(key));
+        if (index == slots.size()) {
+            return 0;
+        }
+        erase(iterator(&slots, index));
+        return 1;
+    }
+
+    void
+    clear()
+    {
+        slots.clear();
+        full_count   = 0;
+        erased_count = 0;
+    }
+
+    /*! Get the keys of the map, in sorted order.
+     *  @param keys The buffer for the keys.
+     */
+    void
+    getSortedKeys(std::vector<std::string> *keys)
+    {
+        for (iterator b = begin(), e = end(); b != e; ++b) {
+            keys->push_back(b->first);
+        }
+        std::sort(keys->begin(), keys->end());
+    }
+};
+}
+
+#endif
@@ -0,0 +1,81 @@
+#include "InstantiationMap.h"
+
+#include <vector>
+#include <algorithm>
+
+namespace dale
+{
+HashMap<std::string> dale_instantiation_map;
+static std::vector<std::string> pending_instantiations;
+
+bool
+addInstantiationEntry(const char *key, const char *module_name)
+{
+    dale_instantiation_map.insert(
+        std::pair<std::string, std::string>(key, module_name)
+    );
+    return true;
+}
+
+bool
+addPendingInstantiationEntry(const char *key)
+{
+    if (existsInstantiationEntry(key)) {
+        return false;
+    }
+    pending_instantiations.push_back(key);
+    return true;
+}
+
+bool
+existsInstantiationEntry(const char *key)
+{
+    std::string key_str(key);
+    if (dale_instantiation_map.count(key_str)) {
+        return true;
+    }
+    return (std::find(pending_instantiations.begin(),
+                      pending_instantiations.end(),
+                      key_str) != pending_instantiations.end());
+}
+
+int
+getPendingInstantiationCount()
+{
+    return pending_instantiations.size();
+}
+
+void
+commitPendingInstantiations()
+{
+    for (std::vector<std::string>::iterator
+                b = pending_instantiations.begin(),
+                e = pending_instantiations.end();
+            b != e;
+            ++b) {
+        addInstantiationEntry(b->c_str(), "");
+    }
+    pending_instantiations.clear();
+}
+
+void
+discardPendingInstantiations(int count)
+{
+    if (count < (int) pending_instantiations.size()) {
+        pending_instantiations.resize(count);
+    }
+}
+
+void
+getLocalInstantiations(HashMap<std::string> *local)
+{
+    for (HashMap<std::string>::iterator b = dale_instantiation_map.begin(),
+                                        e = dale_instantiation_map.end();
+            b != e;
+            ++b) {
+        if (b->second.empty()) {
+            local->insert(*b);
+        }
+    }
+}
+}
@@ -0,0 +1,62 @@
+#ifndef DALE_ELEMENT_INSTANTIATIONMAP
+#define DALE_ELEMENT_INSTANTIATIONMAP
+
+#include "../HashMap/HashMap.h"
+
+#include <string>
+
+namespace dale
+{
+/*! InstantiationMap
+
+    Provides functions for recording concept macro instantiations (see
+    std.concepts.instantiate), so that an instantiation that has
+    already taken place, whether in the current compilation or in an
+    imported module, is not expanded again.  Each key describes the
+    namespace in which the instantiation took place, the concept macro
+    name and the canonical argument types.
+
+    Instantiations recorded while a top-level form is being processed
+    are pending until that form has been processed without errors, at
+    which point they are committed.  Only committed instantiations are
+    written to the module file.
+*/
+
+/*! A map from instantiation key to the name of the module from which
+ *  the instantiation was imported.  The module name is the empty
+ *  string for instantiations made by the current compilation. */
+extern HashMap<std::string> dale_instantiation_map;
+
+/*! Add a committed instantiation entry.
+ *  @param key The instantiation key.
+ *  @param module_name The name of the module that made the instantiation.
+ */
+bool addInstantiationEntry(const char *key, const char *module_name);
+/*! Add a pending instantiation entry.
+ *  @param key The instantiation key.
+ */
+bool addPendingInstantiationEntry(const char *key);
+/*! Check whether an instantiation has been recorded.
+ *  @param key The instantiation key.
+ *
+ *  Both committed and pending entries are checked.
+ */
+bool existsInstantiationEntry(const char *key);
+/*! Get the number of pending instantiation entries. */
+int getPendingInstantiationCount();
+/*! Commit all pending instantiation entries. */
+void commitPendingInstantiations();
+/*! Discard pending instantiation entries.
+ *  @param count The number of pending entries to retain.
+ *
+ *  Entries are discarded in the reverse of the order in which they
+ *  were added.
+ */
+void discardPendingInstantiations(int count);
+/*! Get the instantiation entries made by the current compilation.
+ *  @param local The map to which the entries will be added.
+ */
+void getLocalInstantiations(HashMap<std::string> *local);
+}
+
+#endif
@@ -3,11 +3,130 @@
 #include "../Form/Type/Type.h"
 #include "../Form/Proc/Inst/Inst.h"
 #include "../Utils/Utils.h"
+#include "../HashMap/HashMap.h"
+#include "../InstantiationMap/InstantiationMap.h"
 
 using namespace dale;
 
 std::map<std::string, std::vector<std::string>*> fn_by_args;
 
+template <typename T>
+static void
+appendBytes(std::string *str, T value)
+{
+    str->append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+/* Probe results depend on the current context, and its active and
+ * used namespaces.  A change to any of these changes the namespace
+ * scope, which discards all cached probe results. */
+static void
+getNamespaceScope(Units *units, std::string *scope)
+{
+    Context *ctx = units->top()->ctx;
+    appendBytes(scope, ctx);
+    appendBytes(scope, ctx->active_ns_nodes.back());
+    for (std::vector<NSNode *>::iterator b = ctx->used_ns_nodes.begin(),
+                                         e = ctx->used_ns_nodes.end();
+            b != e;
+            ++b) {
+        appendBytes(scope, *b);
+    }
+}
+
+/* has-errors results may depend on any binding, so their scope also
+ * includes the binding generations. */
+static void
+getProbeScope(Units *units, std::string *scope)
+{
+    getNamespaceScope(units, scope);
+    appendBytes(scope, Namespace::overload_changes.generation);
+    appendBytes(scope, Namespace::variable_changes.generation);
+    appendBytes(scope, Namespace::struct_changes.generation);
+}
+
+static bool
+getCachedProbe(Units *units, std::string *key, bool *result)
+{
+    std::string scope;
+    getProbeScope(units, &scope);
+    if (scope != units->probe_scope) {
+        units->probe_results.clear();
+        units->probe_scope = scope;
+        return false;
+    }
+
+    HashMap<bool>::iterator iter = units->probe_results.find(*key);
+    if (iter == units->probe_results.end()) {
+        return false;
+    }
+    *result = iter->second;
+    return true;
+}
+
+/* Probes that change the scope themselves (e.g. by way of macros
+ * that add bindings) are not cached. */
+static void
+cacheProbe(Units *units, std::string *key, bool result)
+{
+    std::string scope;
+    getProbeScope(units, &scope);
+    if (scope == units->probe_scope) {
+        units->probe_results.insert(
+            std::pair<std::string, bool>(*key, result)
+        );
+    }
+}
+
+typedef std::pair<std::string, std::vector<Type *> > FunctionProbeKey;
+
+/* exists-fn results depend only on the functions bound to the given
+ * name, so they are invalidated by name, as the overloads for that
+ * name change (see Namespace::clearFunctionLookups).  Changes are
+ * recorded against the unqualified name. */
+static int
+getOverloadGeneration(const std::string &name)
+{
+    size_t dot = name.rfind('.');
+    return Namespace::overload_changes.getGeneration(
+        (dot == std::string::npos) ? name : name.substr(dot + 1)
+    );
+}
+
+static bool
+getCachedFunctionProbe(Units *units, FunctionProbeKey *key, bool *result)
+{
+    std::string scope;
+    getNamespaceScope(units, &scope);
+    if (scope != units->fn_probe_scope) {
+        units->fn_probe_results.clear();
+        units->fn_probe_scope = scope;
+        return false;
+    }
+
+    std::map<FunctionProbeKey, std::pair<int, bool> >::iterator iter =
+        units->fn_probe_results.find(*key);
+    if (iter == units->fn_probe_results.end()) {
+        return false;
+    }
+    if (iter->second.first != getOverloadGeneration(key->first)) {
+        return false;
+    }
+    *result = iter->second.second;
+    return true;
+}
+
+static void
+cacheFunctionProbe(Units *units, FunctionProbeKey *key, bool result)
+{
+    std::string scope;
+    getNamespaceScope(units, &scope);
+    if (scope == units->fn_probe_scope) {
+        units->fn_probe_results[*key] =
+            std::make_pair(getOverloadGeneration(key->first), result);
+    }
+}
+
 extern "C" {
 Node *
 WrapNode(Node *n)
@@ -208,39 +327,48 @@ has_2D_errors(MContext *mc, DNode *form)
 
     Node *n = units->top()->dnc->toNode(form);
 
-    int error_count_begin =
-        units->top()->ctx->er->getErrorTypeCount(ErrorType::Error);
-
-    bool made_temp = false;
-    std::vector<DeferredGoto*> dgs;
-    std::map<std::string, Label*> mls;
-    if (!units->top()->getGlobalFunction()) {
-        units->top()->makeTemporaryGlobalFunction();
-        made_temp = true;
+    std::string key("has-errors");
+    appendNodeKey(n, &key);
+    bool cached;
+    if (getCachedProbe(units, &key, &cached)) {
+        return cached;
     }
 
-    ParseResult pr;
+    ErrorReporter *er = units->top()->ctx->er;
+    ErrorCheckpoint cp;
+    er->setCheckpoint(&cp);
+    int pending_instantiations = getPendingInstantiationCount();
 
     /* POMC may succeed, but the underlying macro may return a null
      * DNode pointer.  This is not necessarily an error. */
     n = units->top()->mp->parsePotentialMacroCall(n);
-    if (n) {
+
+    Type *type = NULL;
+    if (n && !FormProcInstParseTypeOnly(units, n, false, NULL, &type)) {
+        bool made_temp = false;
+        if (!units->top()->getGlobalFunction()) {
+            units->top()->makeTemporaryGlobalFunction();
+            made_temp = true;
+        }
+
+        ParseResult pr;
         FormProcInstParse(units, units->top()->getGlobalFunction(),
                           units->top()->getGlobalBlock(),
                           n, false, false, NULL, &pr);
-    }
 
-    if (made_temp) {
-        units->top()->removeTemporaryGlobalFunction();
+        if (made_temp) {
+            units->top()->removeTemporaryGlobalFunction();
+        }
     }
 
-    int error_count_end =
-        units->top()->ctx->er->getErrorTypeCount(ErrorType::Error);
-
     bool has_errors =
-        ((error_count_end - error_count_begin) != 0);
+        (er->getErrorTypeCountSince(&cp, ErrorType::Error) != 0);
 
-    units->top()->ctx->er->popErrors(error_count_begin);
+    er->rollback(&cp, NULL);
+    /* The form is not actually evaluated, so any instantiations made
+     * while checking it have not taken place. */
+    discardPendingInstantiations(pending_instantiations);
+    cacheProbe(units, &key, has_errors);
     return has_errors;
 }
 
@@ -287,6 +415,13 @@ exists_2D_fn(MContext *mc, DNode *form)
         ++iter;
     }
 
+    FunctionProbeKey key(node_function_name->token->str_value,
+                         parameter_types);
+    bool cached;
+    if (getCachedFunctionProbe(units, &key, &cached)) {
+        return cached;
+    }
+
     Function *fn =
         units->top()->ctx->getFunction(
             node_function_name->token->str_value.c_str(),
@@ -294,7 +429,9 @@ exists_2D_fn(MContext *mc, DNode *form)
         );
 
     units->top()->ctx->er->popErrors(error_count_begin);
-    return (fn && !fn->is_macro);
+    bool exists = (fn && !fn->is_macro);
+    cacheFunctionProbe(units, &key, exists);
+    return exists;
 }
 
 bool
@@ -509,6 +646,98 @@ register_2D_type(MContext *mc, const char *from, const char *to)
     return true;
 }
 
+/* Appends the key part for a single instantiation argument: the
+ * canonical type string, or the token itself for non-type token
+ * arguments.  Returns false if the argument cannot be keyed. */
+static bool
+appendInstantiationArgumentKey(Units *units, Node *n, std::string *key)
+{
+    ErrorReporter *er = units->top()->ctx->er;
+    ErrorCheckpoint cp;
+    er->setCheckpoint(&cp);
+    Type *type = FormTypeParse(units, n, false, false);
+    er->rollback(&cp, NULL);
+
+    if (type) {
+        type->toString(key);
+        return true;
+    }
+    if (n->is_token) {
+        key->append("value:").append(n->token->str_value);
+        return true;
+    }
+    return false;
+}
+
+/* Builds the instantiation key for the given macro name and
+ * arguments.  Returns false if the instantiation should not be
+ * recorded, which is the case for instantiations within anonymous
+ * namespaces, and for arguments that cannot be keyed. */
+static bool
+getInstantiationKey(Units *units, DNode *macro_name, DNode *args,
+                    std::string *key)
+{
+    if (!macro_name || macro_name->is_list || !macro_name->token_str) {
+        return false;
+    }
+
+    std::vector<std::string> namespaces;
+    units->top()->ctx->ns()->setNamespaces(&namespaces);
+    for (std::vector<std::string>::iterator b = namespaces.begin(),
+                                            e = namespaces.end();
+            b != e;
+            ++b) {
+        if (b->find("anon") == 0) {
+            return false;
+        }
+        key->append(*b).append(".");
+    }
+    key->append(" ").append(macro_name->token_str);
+
+    for (DNode *arg = args; arg; arg = arg->next_node) {
+        Node *n = units->top()->dnc->toNode(arg);
+        key->append(" ");
+        if (n->is_list && (n->list->size() == 3)
+                && (*n->list)[0]->is_token
+                && !(*n->list)[0]->token->str_value.compare("force")
+                && (*n->list)[1]->is_token) {
+            key->append("force:")
+                .append((*n->list)[1]->token->str_value)
+                .append(":");
+            n = (*n->list)[2];
+        }
+        if (!appendInstantiationArgumentKey(units, n, key)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+exists_2D_instantiation(MContext *mc, DNode *macro_name, DNode *args)
+{
+    dale::Units *units = (dale::Units*) mc->units;
+
+    std::string key;
+    if (!getInstantiationKey(units, macro_name, args, &key)) {
+        return false;
+    }
+    return existsInstantiationEntry(key.c_str());
+}
+
+bool
+register_2D_instantiation(MContext *mc, DNode *macro_name, DNode *args)
+{
+    dale::Units *units = (dale::Units*) mc->units;
+
+    std::string key;
+    if (!getInstantiationKey(units, macro_name, args, &key)) {
+        return false;
+    }
+    return addPendingInstantiationEntry(key.c_str());
+}
+
 DNode *
 type_2D_of(MContext *mc, DNode *form)
 {
@@ -516,29 +745,34 @@ type_2D_of(MContext *mc, DNode *form)
 
     Node *n = units->top()->dnc->toNode(form);
 
-    bool made_temp = false;
-    std::vector<DeferredGoto*> dgs;
-    std::map<std::string, Label*> mls;
-    if (!units->top()->getGlobalFunction()) {
-        units->top()->makeTemporaryGlobalFunction();
-        made_temp = true;
-    }
+    Type *type = NULL;
+    if (!FormProcInstParseTypeOnly(units, n, false, NULL, &type)) {
+        bool made_temp = false;
+        if (!units->top()->getGlobalFunction()) {
+            units->top()->makeTemporaryGlobalFunction();
+            made_temp = true;
+        }
 
-    ParseResult pr;
-    bool res =
-        FormProcInstParse(units, units->top()->getGlobalFunction(),
-                          units->top()->getGlobalBlock(),
-                          n, false, false, NULL, &pr);
+        ParseResult pr;
+        bool res =
+            FormProcInstParse(units, units->top()->getGlobalFunction(),
+                              units->top()->getGlobalBlock(),
+                              n, false, false, NULL, &pr);
+
+        if (made_temp) {
+            units->top()->removeTemporaryGlobalFunction();
+        }
 
-    if (made_temp) {
-        units->top()->removeTemporaryGlobalFunction();
+        if (res) {
+            type = pr.type;
+        }
     }
 
-    if (!res) {
+    if (!type) {
         return NULL;
     }
 
-    return pr.type->toNode()->toDNode();
+    return type->toNode()->toDNode();
 }
 
 const char *
@@ -807,7 +1041,49 @@ struct_2D_member_2D_count(MContext *mc, DNode *name)
     return st->member_types.size();
 }
 
-static std::map<std::string, void*> fns;
+int
+location_2D_line(MContext *mc, uint32_t location)
+{
+    Position position;
+    position.setLocation(location);
+    return position.getLineNumber();
+}
+
+int
+location_2D_column(MContext *mc, uint32_t location)
+{
+    Position position;
+    position.setLocation(location);
+    return position.getColumnNumber();
+}
+
+uint32_t
+make_2D_location(MContext *mc, int line_number, int column_number)
+{
+    Position position(line_number, column_number);
+    return position.getLocation();
+}
+
+static uint32_t
+getPackedLocation(uint32_t location)
+{
+    Position position;
+    position.setLocation(location);
+    return position.getPackedLocation();
+}
+
+void
+copy_2D_location(MContext *mc, DNode *dst, DNode *src)
+{
+    dst->begin_location = getPackedLocation(src->begin_location);
+    dst->end_location   = getPackedLocation(src->end_location);
+    dst->macro_begin_location =
+        getPackedLocation(src->macro_begin_location);
+    dst->macro_end_location =
+        getPackedLocation(src->macro_end_location);
+}
+
+static HashMap<void *> fns;
 
 void
 init_introspection_functions()
@@ -823,6 +1099,8 @@ init_introspection_functions()
     fns["type-to-string"]           = (void *) type_2D_to_2D_string;
     fns["type-to-display-string"]   = (void *) type_2D_to_2D_display_2D_string;
     fns["register-type"]            = (void *) register_2D_type;
+    fns["exists-instantiation"]     = (void *) exists_2D_instantiation;
+    fns["register-instantiation"]   = (void *) register_2D_instantiation;
     fns["struct-member-count"]      = (void *) struct_2D_member_2D_count;
     fns["struct-member-type"]       = (void *) struct_2D_member_2D_type;
     fns["struct-member-name"]       = (void *) struct_2D_member_2D_name;
@@ -839,6 +1117,10 @@ init_introspection_functions()
     fns["fn-by-args-name"]          = (void *) fn_2D_by_2D_args_2D_name;
     fns["has-errors"]               = (void *) has_2D_errors;
     fns["is-const"]                 = (void *) is_2D_const;
+    fns["location-line"]            = (void *) location_2D_line;
+    fns["location-column"]          = (void *) location_2D_column;
+    fns["make-location"]            = (void *) make_2D_location;
+    fns["copy-location"]            = (void *) copy_2D_location;
 }
 
 #define eq(str) !strcmp(name, str)
@@ -846,7 +1128,7 @@ init_introspection_functions()
 void *
 find_introspection_function(const char *name)
 {
-    std::map<std::string, void*>::iterator b = fns.find(name);
+    HashMap<void *>::iterator b = fns.find(name);
     if (b == fns.end()) {
         return NULL;
     }
@@ -128,6 +128,28 @@ extern "C" {
      */
     bool register_2D_type(MContext *mc, const char *from, const char *to);
 
+    /*! Check whether a concept macro instantiation has already taken
+     *  place.
+     *  @param mc The current macro context.
+     *  @param macro_name The concept macro name node.
+     *  @param args The first argument node.
+     *
+     *  The argument nodes are linked by way of next_node.
+     *  Instantiations made by imported modules are included.
+     */
+    bool exists_2D_instantiation(MContext *mc, DNode *macro_name,
+                                 DNode *args);
+    /*! Record a concept macro instantiation.
+     *  @param mc The current macro context.
+     *  @param macro_name The concept macro name node.
+     *  @param args The first argument node.
+     *
+     *  The instantiation is pending until the current top-level form
+     *  has been processed without errors.
+     */
+    bool register_2D_instantiation(MContext *mc, DNode *macro_name,
+                                   DNode *args);
+
     /*! Get the type of a given form.
      *  @param mc The current macro context.
      *  @param form The form.
@@ -199,6 +221,35 @@ extern "C" {
     const char *struct_2D_member_2D_name(MContext *mc, DNode *name,
                                          int index);
 
+    /*! Get the line number for a node location.
+     *  @param mc The current macro context.
+     *  @param location The location (e.g. the begin-location of a
+     *                  DNode).
+     */
+    int location_2D_line(MContext *mc, uint32_t location);
+    /*! Get the column number for a node location.
+     *  @param mc The current macro context.
+     *  @param location The location.
+     */
+    int location_2D_column(MContext *mc, uint32_t location);
+    /*! Make a node location from a line and column number.
+     *  @param mc The current macro context.
+     *  @param line_number The line number.
+     *  @param column_number The column number.
+     */
+    uint32_t make_2D_location(MContext *mc, int line_number,
+                              int column_number);
+    /*! Copy the locations of one node to another.
+     *  @param mc The current macro context.
+     *  @param dst The destination node.
+     *  @param src The source node.
+     *
+     *  The locations are copied in packed form where possible (see
+     *  Position::getPackedLocation), so that they remain valid if
+     *  they are written into generated code.
+     */
+    void copy_2D_location(MContext *mc, DNode *dst, DNode *src);
+
     /*! Initialise introspection function lookup.
      *
      *  This must be called at least once before
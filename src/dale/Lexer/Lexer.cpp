@@ -1,6 +1,7 @@
 #include "Lexer.h"
 
 #include "../Utils/Utils.h"
+#include "../FileTable/FileTable.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -8,9 +9,13 @@
 
 namespace dale
 {
+static const int READ_SIZE = 8192;
+
 Lexer::Lexer(FILE *file, int line_number, int column_number)
 {
-    current.setLineAndColumn(line_number, column_number);
+    this->line_number   = line_number;
+    this->column_number = column_number;
+    sequence = FileTable::addSequence();
     this->file = file;
 
     count = 0;
@@ -19,6 +24,7 @@ Lexer::Lexer(FILE *file, int line_number, int column_number)
     been_pushed = false;
     reset_position = false;
 
+    buf.resize(READ_SIZE + 1);
     buf[0] = '\0';
 }
 
@@ -30,7 +36,7 @@ int
 Lexer::getchar_()
 {
     if (count == 0) {
-        int bytes = fread(buf, 1, 8192, file);
+        int bytes = fread(&buf[0], 1, READ_SIZE, file);
         if (!bytes) {
             return EOF;
         }
@@ -40,7 +46,9 @@ Lexer::getchar_()
 
         if (been_pushed) {
             been_pushed = false;
-            current.setLineAndColumn(1,1);
+            line_number   = 1;
+            column_number = 1;
+            sequence = FileTable::addSequence();
             reset_position = true;
         }
     }
@@ -57,12 +65,27 @@ Lexer::ungetchar_(char c)
     --index;
 }
 
+void
+Lexer::setPosition(Position *position, int line_number, int column_number)
+{
+    uint32_t location =
+        FileTable::getLocation(sequence, line_number, column_number);
+    if (location) {
+        position->setLocation(location);
+    } else {
+        position->setLineAndColumn(line_number, column_number);
+    }
+}
+
 void
 Lexer::pushText(const char *text)
 {
     int len = strlen(text);
-    assert((len + count) <= 8192);
-    strcat(buf, text);
+    size_t required = index + count + len + 1;
+    if (required > buf.size()) {
+        buf.resize(required);
+    }
+    memcpy(&buf[index + count], text, len + 1);
     count += len;
     been_pushed = true;
 }
@@ -87,8 +110,8 @@ Lexer::getNextToken(Token *token, Error *error)
     }
 
     /* Set when a token is hit: will be used for token begin position. */
-    int begin_line_count = current.getLineNumber();
-    int begin_col_count  = current.getColumnNumber();
+    int begin_line_count = line_number;
+    int begin_col_count  = column_number;
 
     /* Set everytime: will be the last position for the token as well
      * as the current position for the context. */
@@ -283,21 +306,16 @@ Lexer::getNextToken(Token *token, Error *error)
         }
     }
 
-    current.setLineAndColumn(end_line_count, end_col_count);
+    line_number   = end_line_count;
+    column_number = end_col_count;
 
     if (error->instance == ErrorInst::Null) {
-        token->begin.setLineAndColumn(
-            begin_line_count,
-            begin_col_count
-        );
-        current.copyTo(&(token->end));
+        setPosition(&(token->begin), begin_line_count, begin_col_count);
+        setPosition(&(token->end), end_line_count, end_col_count);
         return true;
     } else {
-        error->begin.setLineAndColumn(
-            begin_line_count,
-            begin_col_count
-        );
-        current.copyTo(&(error->end));
+        setPosition(&(error->begin), begin_line_count, begin_col_count);
+        setPosition(&(error->end), end_line_count, end_col_count);
         return false;
     }
 }
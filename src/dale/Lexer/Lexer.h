@@ -19,12 +19,17 @@ class Lexer
 private:
     /*! The file pointer for the current file. */
     FILE *file;
-    /*! The current position. */
-    Position current;
+    /*! The current line number. */
+    int line_number;
+    /*! The current column number. */
+    int column_number;
+    /*! The FileTable sequence for the current position. */
+    int sequence;
     /*! A stack of "ungot" tokens.  See ungetToken. */
     std::vector<Token *> ungot_tokens;
-    /*! The file buffer. */
-    char buf[8193];
+    /*! The file buffer.  This grows as necessary to accommodate
+     *  pushed text. */
+    std::vector<char> buf;
     /*! The number of bytes remaining to be processed from buf. */
     int count;
     /*! The index of the next byte to be processed from buf. */
@@ -38,6 +43,13 @@ private:
     int getchar_();
     /*! Unget a character. */
     void ungetchar_(char c);
+    /*! Set a position from a line and column number.
+     *  @param position The position.
+     *  @param line_number The line number.
+     *  @param column_number The column number.
+     */
+    void setPosition(Position *position, int line_number,
+                     int column_number);
 
 public:
     /*! Construct a new lexer.
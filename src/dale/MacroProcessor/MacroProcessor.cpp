@@ -1,6 +1,8 @@
 #include "MacroProcessor.h"
 
 #include "../Node/Node.h"
+#include "../DNodeArena/DNodeArena.h"
+#include "../MacroProfile/MacroProfile.h"
 #include "../Form/Proc/Inst/Inst.h"
 #include "../Form/Macro/ArrayDeref/ArrayDeref.h"
 #include "../Form/Macro/StructDeref/StructDeref.h"
@@ -9,6 +11,11 @@
 #include "../Form/Macro/Setv/Setv.h"
 #include FFI_HEADER
 
+#include "../llvm_IRBuilder.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <set>
+
 #define eq(str) !strcmp(macro_name, str)
 
 using namespace dale::ErrorInst;
@@ -18,23 +25,93 @@ namespace dale
 llvm::Function *pool_free_fn;
 void (*pool_free_fptr)(MContext *);
 
+/* Machine code for macros, keyed by execution engine and by the IR
+ * of the macro and everything it refers to (see appendFunctionKey).  This lets a macro share
+ * code with an earlier, identical LLVM function, as happens when a
+ * module into which a macro has already been compiled is linked into
+ * another module.  It is shared by all units, since they share the
+ * execution engine. */
+static std::map<std::pair<llvm::ExecutionEngine *, std::string>, void *>
+    compiled_macros;
+
 MacroProcessor::MacroProcessor(Units *units, Context *ctx,
                                llvm::ExecutionEngine* ee)
 {
     this->units = units;
     this->ctx = ctx;
     this->ee = ee;
+    expansion_depth = 0;
 }
 
 MacroProcessor::~MacroProcessor()
 {
+    std::vector<Node *> cached;
+    for (std::map<std::pair<Function *, std::string>, Node *>::iterator
+            b = expansion_cache.begin(), e = expansion_cache.end();
+            b != e;
+            ++b) {
+        cached.push_back(b->second);
+    }
+    deleteNodeTrees(&cached);
+}
+
+static Node *
+copyNodeShallow(Node *node, Node *pos_node)
+{
+    Node *copy;
+    if (node->is_token) {
+        copy = new Node(new Token(node->token));
+    } else if (node->is_list) {
+        copy = new Node(new std::vector<Node *>());
+    } else {
+        copy = new Node();
+    }
+    pos_node->getBeginPos()->copyTo(copy->getBeginPos());
+    pos_node->getEndPos()->copyTo(copy->getEndPos());
+    copy->filename = pos_node->filename;
+    return copy;
+}
+
+/* Copy a cached expansion.  Each node in the copy takes its position
+ * from pos_node, since positions within the cached expansion refer
+ * to the call for which the expansion was first generated. */
+static Node *
+copyExpansion(Node *node, Node *pos_node)
+{
+    Node *top_copy = copyNodeShallow(node, pos_node);
+
+    std::vector<std::pair<Node *, Node *> > pending;
+    pending.push_back(std::make_pair(node, top_copy));
+
+    while (!pending.empty()) {
+        Node *original = pending.back().first;
+        Node *copy     = pending.back().second;
+        pending.pop_back();
+
+        if (!original->is_list) {
+            continue;
+        }
+
+        copy->list->reserve(original->list->size());
+        for (std::vector<Node *>::iterator b = original->list->begin(),
+                                           e = original->list->end();
+                b != e;
+                ++b) {
+            Node *element_copy = copyNodeShallow(*b, pos_node);
+            copy->list->push_back(element_copy);
+            pending.push_back(std::make_pair(*b, element_copy));
+        }
+    }
+
+    return top_copy;
 }
 
 static DNode *
-callmacro(int arg_count, void *units, void *mac, DNode **dnodes, MContext *mc)
+callMacroFFI(void *mac, int dnode_count, DNode **dnodes, MContext *mc)
 {
-    ffi_type *args[arg_count];
-    void *vals[arg_count];
+    int arg_count = dnode_count + 1;
+    std::vector<ffi_type *> args(arg_count);
+    std::vector<void *> vals(arg_count);
 
     args[0] = &ffi_type_pointer;
     vals[0] = (void*) &mc;
@@ -46,16 +123,100 @@ callmacro(int arg_count, void *units, void *mac, DNode **dnodes, MContext *mc)
 
     ffi_cif cif;
     ffi_status res = ffi_prep_cif(&cif, FFI_DEFAULT_ABI, arg_count,
-                                  &ffi_type_pointer, args);
+                                  &ffi_type_pointer, &args[0]);
     _unused(res);
     assert((res == FFI_OK) && "prep_cif failed, cannot run macro");
 
     DNode *ret_node = NULL;
-    ffi_call(&cif, (void (*)()) mac, (void *) &ret_node, vals);
+    ffi_call(&cif, (void (*)()) mac, (void *) &ret_node, &vals[0]);
 
     return ret_node;
 }
 
+/* Macros are called directly, by way of a function pointer of the
+ * appropriate type, for up to 8 arguments (fixed-arity macros) or 16
+ * arguments (varargs macros).  libffi is only used for calls with
+ * more arguments than that. */
+
+#define PARAMS1 DNode *
+#define PARAMS2 PARAMS1, DNode *
+#define PARAMS3 PARAMS2, DNode *
+#define PARAMS4 PARAMS3, DNode *
+#define PARAMS5 PARAMS4, DNode *
+#define PARAMS6 PARAMS5, DNode *
+#define PARAMS7 PARAMS6, DNode *
+#define PARAMS8 PARAMS7, DNode *
+#define PARAMS9 PARAMS8, DNode *
+#define PARAMS10 PARAMS9, DNode *
+#define PARAMS11 PARAMS10, DNode *
+#define PARAMS12 PARAMS11, DNode *
+#define PARAMS13 PARAMS12, DNode *
+#define PARAMS14 PARAMS13, DNode *
+#define PARAMS15 PARAMS14, DNode *
+#define PARAMS16 PARAMS15, DNode *
+
+#define ARGS1 d[0]
+#define ARGS2 ARGS1, d[1]
+#define ARGS3 ARGS2, d[2]
+#define ARGS4 ARGS3, d[3]
+#define ARGS5 ARGS4, d[4]
+#define ARGS6 ARGS5, d[5]
+#define ARGS7 ARGS6, d[6]
+#define ARGS8 ARGS7, d[7]
+#define ARGS9 ARGS8, d[8]
+#define ARGS10 ARGS9, d[9]
+#define ARGS11 ARGS10, d[10]
+#define ARGS12 ARGS11, d[11]
+#define ARGS13 ARGS12, d[12]
+#define ARGS14 ARGS13, d[13]
+#define ARGS15 ARGS14, d[14]
+#define ARGS16 ARGS15, d[15]
+
+#define CALL_FIXED(n) \
+    case n: return ((DNode *(*)(MContext *, PARAMS##n)) mac)(mc, ARGS##n)
+#define CALL_VARARGS(n) \
+    case n: return ((DNode *(*)(MContext *, ...)) mac)(mc, ARGS##n)
+
+static DNode *
+callMacroFixed(void *mac, int dnode_count, DNode **d, MContext *mc)
+{
+    switch (dnode_count) {
+    case 0: return ((DNode *(*)(MContext *)) mac)(mc);
+    CALL_FIXED(1); CALL_FIXED(2); CALL_FIXED(3); CALL_FIXED(4);
+    CALL_FIXED(5); CALL_FIXED(6); CALL_FIXED(7); CALL_FIXED(8);
+    default:
+        return callMacroFFI(mac, dnode_count, d, mc);
+    }
+}
+
+/* Every macro argument is a pointer, and the supported platforms
+ * pass variadic pointer arguments in the same way as fixed ones, so
+ * a varargs macro may be called through a prototype that has only
+ * the MContext as a fixed parameter, regardless of the number of
+ * fixed parameters the macro actually has.  (The libffi fallback
+ * makes the same assumption.) */
+static DNode *
+callMacroVarArgs(void *mac, int dnode_count, DNode **d, MContext *mc)
+{
+    switch (dnode_count) {
+    CALL_VARARGS(1);  CALL_VARARGS(2);  CALL_VARARGS(3);  CALL_VARARGS(4);
+    CALL_VARARGS(5);  CALL_VARARGS(6);  CALL_VARARGS(7);  CALL_VARARGS(8);
+    CALL_VARARGS(9);  CALL_VARARGS(10); CALL_VARARGS(11); CALL_VARARGS(12);
+    CALL_VARARGS(13); CALL_VARARGS(14); CALL_VARARGS(15); CALL_VARARGS(16);
+    default:
+        return callMacroFFI(mac, dnode_count, d, mc);
+    }
+}
+
+static DNode *
+callmacro(Function *fn, void *mac, int dnode_count, DNode **dnodes,
+          MContext *mc)
+{
+    return (fn->isVarArgs())
+        ? callMacroVarArgs(mac, dnode_count, dnodes, mc)
+        : callMacroFixed(mac, dnode_count, dnodes, mc);
+}
+
 void
 MacroProcessor::setPoolfree()
 {
@@ -67,6 +228,107 @@ MacroProcessor::setPoolfree()
     }
 }
 
+/* Append the IR for the function, and for each function and global
+ * variable that it refers to, directly or indirectly, to the key.
+ * Returns false if any of those functions refers to a global variable
+ * that is not constant: code bound to one copy of such a variable
+ * may not be used in place of code for another copy. */
+static bool
+appendFunctionKey(llvm::Function *llvm_fn, std::string *key)
+{
+    llvm::raw_string_ostream stream(*key);
+    std::set<llvm::Value *> seen;
+    std::vector<llvm::Function *> pending_fns;
+    std::vector<llvm::Value *> pending_values;
+
+    pending_fns.push_back(llvm_fn);
+    seen.insert(llvm_fn);
+
+    while (!pending_fns.empty()) {
+        llvm::Function *current = pending_fns.back();
+        pending_fns.pop_back();
+        current->print(stream);
+
+        for (llvm::Function::iterator bb = current->begin(),
+                                      be = current->end();
+                bb != be;
+                ++bb) {
+            for (llvm::BasicBlock::iterator ib = bb->begin(),
+                                            ie = bb->end();
+                    ib != ie;
+                    ++ib) {
+                pending_values.insert(pending_values.end(),
+                                      ib->op_begin(), ib->op_end());
+            }
+        }
+
+        while (!pending_values.empty()) {
+            llvm::Value *value = pending_values.back();
+            pending_values.pop_back();
+            if (!llvm::isa<llvm::Constant>(value) || seen.count(value)) {
+                continue;
+            }
+            seen.insert(value);
+
+            if (llvm::Function *fn = llvm::dyn_cast<llvm::Function>(value)) {
+                if (!fn->isDeclaration()) {
+                    pending_fns.push_back(fn);
+                }
+            } else if (llvm::GlobalVariable *var =
+                           llvm::dyn_cast<llvm::GlobalVariable>(value)) {
+                if (!var->isConstant()) {
+                    return false;
+                }
+                var->print(stream);
+            } else if (!llvm::isa<llvm::GlobalValue>(value)) {
+                llvm::User *user = llvm::cast<llvm::User>(value);
+                pending_values.insert(pending_values.end(),
+                                      user->op_begin(), user->op_end());
+            }
+        }
+    }
+
+    stream.flush();
+    return true;
+}
+
+static void *
+getMacroPointer(llvm::ExecutionEngine *ee, Function *mc)
+{
+    llvm::Function *llvm_fn = mc->llvm_function;
+    if (llvm_fn->isDeclaration()) {
+        return ee->getPointerToFunction(llvm_fn);
+    }
+
+    /* The key is only computed on the first call.  A refetch follows
+     * the linking of the macro's module into another module, which
+     * does not change the macro's code, so the same key still
+     * applies. */
+    if (!mc->macro_fptr) {
+        std::string key;
+        if (appendFunctionKey(llvm_fn, &key)) {
+            mc->macro_code_key = key;
+        }
+    }
+    if (mc->macro_code_key.empty()) {
+        return ee->getPointerToFunction(llvm_fn);
+    }
+
+    std::pair<llvm::ExecutionEngine *, std::string> key;
+    key.first = ee;
+    key.second = mc->macro_code_key;
+
+    std::map<std::pair<llvm::ExecutionEngine *, std::string>,
+             void *>::iterator b = compiled_macros.find(key);
+    if (b != compiled_macros.end()) {
+        return b->second;
+    }
+
+    void *fptr = ee->getPointerToFunction(llvm_fn);
+    compiled_macros.insert(std::make_pair(key, fptr));
+    return fptr;
+}
+
 Node *
 MacroProcessor::parseMacroCall(Node *n, Function *macro_to_call)
 {
@@ -120,8 +382,33 @@ MacroProcessor::parseMacroCall(Node *n, Function *macro_to_call)
         }
     }
 
-    DNode *macro_args[256];
-    int macro_args_count = 0;
+    std::string cache_key;
+    if (mc->is_pure) {
+        for (std::vector<Node *>::iterator b = lst->begin() + 1,
+                                           e = lst->end();
+                b != e;
+                ++b) {
+            appendNodeKey(*b, &cache_key);
+        }
+        std::map<std::pair<Function *, std::string>, Node *>::iterator
+            cached = expansion_cache.find(std::make_pair(mc, cache_key));
+        if (cached != expansion_cache.end()) {
+            Node *result_node = copyExpansion(cached->second, n);
+            result_node->addMacroPosition(n);
+            units->expansion_nodes.push_back(result_node);
+            if (MacroProfile::isEnabled()) {
+                MacroProfile::addCall(mc, macro_name, n, 0, 0,
+                                      result_node, expansion_depth);
+            }
+            return result_node;
+        }
+    }
+
+    /* The argument DNodes are allocated from an arena that lasts
+     * for the duration of the call. */
+    DNodeArena arena;
+    std::vector<DNode *> macro_args;
+    macro_args.reserve(size - 1);
 
     for (std::vector<Node *>::iterator b = lst->begin() + 1,
                                        e = lst->end();
@@ -129,9 +416,10 @@ MacroProcessor::parseMacroCall(Node *n, Function *macro_to_call)
             ++b) {
         Node *node = (*b);
         node->addMacroPosition(n);
-        DNode *new_dnode = node->toDNode();
-        macro_args[macro_args_count++] = new_dnode;
+        DNode *new_dnode = node->toDNode(&arena);
+        macro_args.push_back(new_dnode);
     }
+    int macro_args_count = macro_args.size();
 
     PoolNode *pn = (PoolNode *) malloc(sizeof(PoolNode));
     if (!pn) {
@@ -146,25 +434,58 @@ MacroProcessor::parseMacroCall(Node *n, Function *macro_to_call)
     mcontext.pool_node = pn;
     mcontext.units     = units;
 
-    void *callmacro_fptr = (void*) &callmacro;
-    void *macro_fptr     = ee->getPointerToFunction(mc->llvm_function);
+    bool profile = MacroProfile::isEnabled();
+    double compile_time = 0;
+    double execute_time = 0;
+    double start_time = 0;
 
-    DNode* (*callmacro_fptr_typed)
-        (int arg_count, void *units, void *mac_fn, DNode **dnodes,
-         MContext *mcp) =
-            (DNode* (*)(int, void*, void*, DNode**, MContext*)) callmacro_fptr;
+    if (!mc->macro_fptr || (mc->macro_fptr_llvm_function
+                                != mc->llvm_function)) {
+        if (profile) {
+            start_time = MacroProfile::getTime();
+        }
+        mc->macro_fptr = getMacroPointer(ee, mc);
+        mc->macro_fptr_llvm_function = mc->llvm_function;
+        if (profile) {
+            compile_time = MacroProfile::getTime() - start_time;
+        }
+    }
+
+    int error_count = ctx->er->getErrorTypeCount(ErrorType::Error);
 
+    if (profile) {
+        start_time = MacroProfile::getTime();
+    }
     DNode *result_dnode =
-        callmacro_fptr_typed(macro_args_count + 1, (void *) units,
-                             (char *) macro_fptr, macro_args, &mcontext);
+        callmacro(mc, mc->macro_fptr, macro_args_count,
+                  (macro_args_count ? &macro_args[0] : NULL),
+                  &mcontext);
+    if (profile) {
+        execute_time = MacroProfile::getTime() - start_time;
+    }
 
     Node *result_node =
-        (result_dnode) ? units->top()->dnc->toNode(result_dnode) : NULL;
+        (result_dnode) ? units->top()->dnc->toNode(result_dnode, &arena)
+                       : NULL;
 
     pool_free_fptr(&mcontext);
 
+    if (profile) {
+        MacroProfile::addCall(mc, macro_name, n, compile_time,
+                              execute_time, result_node, expansion_depth);
+    }
+
     if (result_node) {
+        /* Expansions that led to errors are not cached, so that the
+         * errors are reported for each call. */
+        if (mc->is_pure
+                && (error_count ==
+                    ctx->er->getErrorTypeCount(ErrorType::Error))) {
+            expansion_cache[std::make_pair(mc, cache_key)] =
+                copyExpansion(result_node, result_node);
+        }
         result_node->addMacroPosition(n);
+        units->expansion_nodes.push_back(result_node);
     }
 
     return result_node;
@@ -207,41 +528,60 @@ MacroProcessor::parsePotentialMacroCall(Node *n)
         return n;
     }
 
-    bool made_temp = false;
-    Function *global_fn = units->top()->getGlobalFunction();
-    if (!global_fn) {
-        units->top()->makeTemporaryGlobalFunction();
-        global_fn = units->top()->getGlobalFunction();
-        made_temp = true;
-    }
+    /* The argument types are determined without generating code
+     * where possible.  A temporary global function is only needed if
+     * some argument must be parsed in full. */
 
     std::vector<Type *> types;
-    llvm::BasicBlock *block = &(global_fn->llvm_function->front());
+    std::vector<bool> typed;
+    bool all_typed = true;
 
-    int error_count = ctx->er->getErrorTypeCount(ErrorType::Error);
+    ErrorCheckpoint cp;
+    ctx->er->setCheckpoint(&cp);
     for (std::vector<Node *>::iterator b = lst->begin() + 1,
                                        e = lst->end();
             b != e;
             ++b) {
-        ParseResult arg_pr;
-        bool res =
-            FormProcInstParse(units, global_fn, block, *b, false, false, NULL,
-                              &arg_pr);
-        if (res) {
-            /* Add the type. */
-            types.push_back(arg_pr.type);
-            block = arg_pr.block;
-        }
-        else {
-            /* Add a (p DNode) to types. */
-            types.push_back(ctx->tr->type_pdnode);
+        Type *type = NULL;
+        bool res = FormProcInstParseTypeOnly(units, *b, false, NULL, &type);
+        types.push_back(type ? type : ctx->tr->type_pdnode);
+        typed.push_back(res);
+        if (!res) {
+            all_typed = false;
         }
     }
-    ctx->er->popErrors(error_count);
 
-    if (made_temp) {
-        units->top()->removeTemporaryGlobalFunction();
+    if (!all_typed) {
+        bool made_temp = false;
+        Function *global_fn = units->top()->getGlobalFunction();
+        if (!global_fn) {
+            units->top()->makeTemporaryGlobalFunction();
+            global_fn = units->top()->getGlobalFunction();
+            made_temp = true;
+        }
+
+        llvm::BasicBlock *block = &(global_fn->llvm_function->front());
+
+        for (int i = 0; i < (int) typed.size(); i++) {
+            if (typed[i]) {
+                continue;
+            }
+            ParseResult arg_pr;
+            bool res =
+                FormProcInstParse(units, global_fn, block, (*lst)[i + 1],
+                                  false, false, NULL, &arg_pr);
+            if (res) {
+                /* Add the type. */
+                types[i] = arg_pr.type;
+                block = arg_pr.block;
+            }
+        }
+
+        if (made_temp) {
+            units->top()->removeTemporaryGlobalFunction();
+        }
     }
+    ctx->er->rollback(&cp, NULL);
 
     ffn = ctx->getFunction(macro_name, &types, 1);
     if (!ffn) {
@@ -257,14 +597,19 @@ MacroProcessor::parsePotentialMacroCall(Node *n)
      * elements, and the first element is 'do', then just return the
      * second element. */
 
+    Node *expanded_node = mac_node;
     if ((!mac_node->is_token)
             && (mac_node->list->size() == 2)
             && ((*mac_node->list)[0]->is_token)
             && ((*mac_node->list)[0]
                 ->token->str_value.compare("do") == 0)) {
-        return parsePotentialMacroCall((*mac_node->list)[1]);
-    } else {
-        return parsePotentialMacroCall(mac_node);
+        expanded_node = (*mac_node->list)[1];
     }
+
+    ++expansion_depth;
+    Node *result_node = parsePotentialMacroCall(expanded_node);
+    --expansion_depth;
+
+    return result_node;
 }
 }
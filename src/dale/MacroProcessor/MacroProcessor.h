@@ -3,6 +3,10 @@
 
 #include "../Context/Context.h"
 
+#include <map>
+#include <string>
+#include <utility>
+
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/JIT.h"
 #include "llvm/ExecutionEngine/Interpreter.h"
@@ -37,6 +41,14 @@ class MacroProcessor
 private:
     Units *units;
     Context *ctx;
+    /*! Cached expansions for pure macros.  The key is the macro and
+     *  a string encoding the structure of the macro call's
+     *  arguments, and the value is the expansion from the first
+     *  call.  Cached expansions are copied on reuse. */
+    std::map<std::pair<Function *, std::string>, Node *> expansion_cache;
+    /*! The number of macro expansions currently being re-expanded,
+     *  for profiling. */
+    int expansion_depth;
 
 public:
     llvm::ExecutionEngine *ee;
@@ -0,0 +1,207 @@
+#include "MacroProfile.h"
+
+#include <sys/time.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dale
+{
+namespace MacroProfile
+{
+static const int MAX_CALL_SITES = 20;
+
+struct MacroStats
+{
+    std::string name;
+    int calls;
+    double compile_time;
+    double execute_time;
+    long output_nodes;
+    int max_depth;
+
+    double totalTime() const
+    {
+        return compile_time + execute_time;
+    }
+};
+
+struct CallSiteStats
+{
+    std::string name;
+    std::string position;
+    int calls;
+    double time;
+};
+
+static bool enabled = false;
+static std::map<Function *, MacroStats> macro_stats;
+static std::map<std::pair<Function *, std::string>, CallSiteStats>
+    call_site_stats;
+
+void
+enable()
+{
+    enabled = true;
+}
+
+bool
+isEnabled()
+{
+    return enabled;
+}
+
+double
+getTime()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return ((double) tv.tv_sec * 1000000.0) + (double) tv.tv_usec;
+}
+
+static long
+countNodes(Node *node)
+{
+    long count = 0;
+    std::vector<Node *> pending;
+    pending.push_back(node);
+    while (!pending.empty()) {
+        Node *current = pending.back();
+        pending.pop_back();
+        if (!current) {
+            continue;
+        }
+        ++count;
+        if (current->is_list) {
+            pending.insert(pending.end(), current->list->begin(),
+                           current->list->end());
+        }
+    }
+    return count;
+}
+
+static void
+positionToString(Node *node, std::string *str)
+{
+    int line_number;
+    int column_number;
+    node->getBeginPos()->getLineAndColumn(&line_number, &column_number);
+
+    char buf[64];
+    sprintf(buf, ":%d:%d", line_number, column_number);
+    str->append(node->filename ? node->filename : "<unknown>");
+    str->append(buf);
+}
+
+void
+addCall(Function *fn, const char *name, Node *call_node,
+        double compile_time, double execute_time, Node *result,
+        int depth)
+{
+    std::map<Function *, MacroStats>::iterator b = macro_stats.find(fn);
+    if (b == macro_stats.end()) {
+        MacroStats stats;
+        stats.name         = name;
+        stats.calls        = 0;
+        stats.compile_time = 0;
+        stats.execute_time = 0;
+        stats.output_nodes = 0;
+        stats.max_depth    = 0;
+        b = macro_stats.insert(std::make_pair(fn, stats)).first;
+    }
+    MacroStats *stats = &(b->second);
+    ++stats->calls;
+    stats->compile_time += compile_time;
+    stats->execute_time += execute_time;
+    stats->output_nodes += countNodes(result);
+    stats->max_depth = std::max(stats->max_depth, depth);
+
+    std::string position;
+    positionToString(call_node, &position);
+    std::pair<Function *, std::string> key(fn, position);
+    std::map<std::pair<Function *, std::string>, CallSiteStats>::iterator
+        sb = call_site_stats.find(key);
+    if (sb == call_site_stats.end()) {
+        CallSiteStats site_stats;
+        site_stats.name     = name;
+        site_stats.position = position;
+        site_stats.calls    = 0;
+        site_stats.time     = 0;
+        sb = call_site_stats.insert(std::make_pair(key, site_stats)).first;
+    }
+    ++sb->second.calls;
+    sb->second.time += compile_time + execute_time;
+}
+
+static bool
+macroStatsGreater(const MacroStats *a, const MacroStats *b)
+{
+    return (a->totalTime() > b->totalTime());
+}
+
+static bool
+callSiteStatsGreater(const CallSiteStats *a, const CallSiteStats *b)
+{
+    return (a->time > b->time);
+}
+
+void
+print(FILE *out)
+{
+    std::vector<MacroStats *> sorted_macros;
+    for (std::map<Function *, MacroStats>::iterator
+            b = macro_stats.begin(), e = macro_stats.end();
+            b != e;
+            ++b) {
+        sorted_macros.push_back(&(b->second));
+    }
+    std::stable_sort(sorted_macros.begin(), sorted_macros.end(),
+                     macroStatsGreater);
+
+    fprintf(out, "%-32s %8s %12s %12s %12s %10s %6s\n",
+            "macro", "calls", "compile-ms", "execute-ms", "total-ms",
+            "nodes", "depth");
+    for (std::vector<MacroStats *>::iterator b = sorted_macros.begin(),
+                                             e = sorted_macros.end();
+            b != e;
+            ++b) {
+        MacroStats *stats = (*b);
+        fprintf(out, "%-32s %8d %12.3f %12.3f %12.3f %10ld %6d\n",
+                stats->name.c_str(), stats->calls,
+                stats->compile_time / 1000.0,
+                stats->execute_time / 1000.0,
+                stats->totalTime() / 1000.0,
+                stats->output_nodes, stats->max_depth);
+    }
+
+    std::vector<CallSiteStats *> sorted_sites;
+    for (std::map<std::pair<Function *, std::string>,
+                  CallSiteStats>::iterator
+            b = call_site_stats.begin(), e = call_site_stats.end();
+            b != e;
+            ++b) {
+        sorted_sites.push_back(&(b->second));
+    }
+    std::stable_sort(sorted_sites.begin(), sorted_sites.end(),
+                     callSiteStatsGreater);
+    if (sorted_sites.size() > (size_t) MAX_CALL_SITES) {
+        sorted_sites.resize(MAX_CALL_SITES);
+    }
+
+    fprintf(out, "\n%-48s %-32s %8s %12s\n",
+            "call site", "macro", "calls", "total-ms");
+    for (std::vector<CallSiteStats *>::iterator b = sorted_sites.begin(),
+                                                e = sorted_sites.end();
+            b != e;
+            ++b) {
+        CallSiteStats *stats = (*b);
+        fprintf(out, "%-48s %-32s %8d %12.3f\n",
+                stats->position.c_str(), stats->name.c_str(),
+                stats->calls, stats->time / 1000.0);
+    }
+}
+}
+}
@@ -0,0 +1,51 @@
+#ifndef DALE_MACROPROFILE
+#define DALE_MACROPROFILE
+
+#include "../Node/Node.h"
+
+#include <cstdio>
+
+namespace dale
+{
+class Function;
+
+/*! MacroProfile
+
+    Records statistics about macro calls, for the --macro-profile
+    option: for each macro, the number of calls, the time spent
+    compiling and executing it, the number of nodes it produced, and
+    the greatest depth at which it was called while re-expanding the
+    result of another macro.  Times for individual call sites are also
+    recorded.  Nothing is recorded unless profiling is enabled.
+*/
+namespace MacroProfile
+{
+/*! Enable profiling.
+ */
+void enable();
+/*! Check whether profiling is enabled.
+ */
+bool isEnabled();
+/*! Get the current time, in microseconds.
+ */
+double getTime();
+/*! Record a single macro call.
+ *  @param fn The macro.
+ *  @param name The macro's name, as used in the call.
+ *  @param call_node The node for the call.
+ *  @param compile_time The time spent compiling the macro.
+ *  @param execute_time The time spent executing the macro.
+ *  @param result The macro's expansion, or NULL.
+ *  @param depth The re-expansion depth of the call.
+ */
+void addCall(Function *fn, const char *name, Node *call_node,
+             double compile_time, double execute_time, Node *result,
+             int depth);
+/*! Print the profile report.
+ *  @param out The output stream.
+ */
+void print(FILE *out);
+}
+}
+
+#endif
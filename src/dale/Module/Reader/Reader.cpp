@@ -48,6 +48,7 @@
 #endif
 
 #include "../../Serialise/Serialise.h"
+#include "../../InstantiationMap/InstantiationMap.h"
 #include "../../Utils/Utils.h"
 
 #include <sys/types.h>
@@ -131,6 +132,19 @@ Reader::loadModule(std::string *path)
 
     assert(module && "cannot load module");
 
+#if D_LLVM_VERSION_MINOR <= 4
+    /* The module owns the buffer from here, since function bodies
+     * are read from it on materialisation. */
+    buffer.take();
+#endif
+
+    return module;
+}
+
+void
+Reader::materializeModule(llvm::Module *module)
+{
+    std::string error_msg;
 #if D_LLVM_VERSION_MINOR <= 4
     bool materialized = module->MaterializeAll(&error_msg);
 #else
@@ -143,7 +157,23 @@ Reader::loadModule(std::string *path)
     assert(!materialized && "failed to materialize module");
     _unused(materialized);
 
-    return module;
+    /* Materialisation restores the bodies of functions that were
+     * erased because of 'once' tags, so they have to be erased
+     * again. */
+    std::map<llvm::Module *, std::set<std::string> >::iterator b =
+        erased_functions.find(module);
+    if (b == erased_functions.end()) {
+        return;
+    }
+    for (std::set<std::string>::iterator fb = b->second.begin(),
+                                         fe = b->second.end();
+            fb != fe;
+            ++fb) {
+        llvm::Function *fn = module->getFunction(fb->c_str());
+        if (fn) {
+            fn->deleteBody();
+        }
+    }
 }
 
 bool
@@ -329,6 +359,7 @@ Reader::run(Context *ctx, llvm::Module *mod, Node *n, const char *module_name,
     std::set<std::string> once_tags;
     std::set<std::string> dependencies;
     std::map<std::string, std::string> typemap;
+    std::map<std::string, std::string> instantiations;
     int cto;
 
     data = deserialise(ctx->tr, data, new_ctx);
@@ -336,6 +367,7 @@ Reader::run(Context *ctx, llvm::Module *mod, Node *n, const char *module_name,
     data = deserialise(ctx->tr, data, &dependencies);
     data = deserialise(ctx->tr, data, &cto);
     data = deserialise(ctx->tr, data, &typemap);
+    data = deserialise(ctx->tr, data, &instantiations);
     free(original_data);
 
     for (std::map<std::string, std::string>::iterator b = typemap.begin(),
@@ -347,6 +379,20 @@ Reader::run(Context *ctx, llvm::Module *mod, Node *n, const char *module_name,
         addTypeMapEntry(from.c_str(), to.c_str());
     }
 
+    /* If only some of the module's bindings are being imported, then
+     * the bindings produced by its instantiations may not be
+     * available, so the instantiations are not recorded. */
+    if (import_forms->empty()) {
+        for (std::map<std::string, std::string>::iterator
+                    b = instantiations.begin(),
+                    e = instantiations.end();
+                b != e;
+                ++b) {
+            addInstantiationEntry(b->first.c_str(),
+                                  lib_module_name.c_str());
+        }
+    }
+
     std::string module_path(bc_path);
     std::string module_path_nomacros(bc_path);
 
@@ -385,7 +431,8 @@ Reader::run(Context *ctx, llvm::Module *mod, Node *n, const char *module_name,
                        all_once_tags,
                        all_once_tags.end()
                    ));
-    new_ctx->eraseOnceForms(&all_once_tags, new_module);
+    new_ctx->eraseOnceForms(&all_once_tags, new_module,
+                            &(erased_functions[new_module]));
 
     included_once_tags.clear();
     std::copy(all_once_tags.begin(), all_once_tags.end(),
@@ -410,11 +457,43 @@ Reader::run(Context *ctx, llvm::Module *mod, Node *n, const char *module_name,
     if (!res) {
         return false;
     }
-    ctx->merge(new_ctx);
-    ctx->regetPointersForNewModule(mod);
-    ctx->relink();
+    NewBindings added;
+    ctx->merge(new_ctx, &added);
+    ctx->regetPointersForNewModule(mod, &added);
+
+    /* The module's shared object has been loaded, so the macros that
+     * it added can be called directly, rather than being compiled
+     * again. */
+    for (std::vector<std::pair<std::string, Function *> >::iterator
+            b = added.functions.begin(),
+            e = added.functions.end();
+            b != e;
+            ++b) {
+        Namespace::bindNativeMacro(b->second);
+    }
 
     return true;
 }
+
+FILE *
+Reader::openIncludeFile(const char *path, std::string *path_buf,
+                        const char *mode)
+{
+    FILE *file = NULL;
+    for (std::vector<const char *>::iterator
+                b = include_directory_paths.begin(),
+                e = include_directory_paths.end();
+            b != e;
+            ++b) {
+        path_buf->clear();
+        path_buf->append((*b));
+        path_buf->append(path);
+        file = fopen(path_buf->c_str(), mode);
+        if (file) {
+            break;
+        }
+    }
+    return file;
+}
 }
 }
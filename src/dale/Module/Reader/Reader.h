@@ -31,6 +31,9 @@ private:
      */
     bool findModule(Context *ctx, Node *n, std::string *lib_module_name,
                     FILE **fh, std::string *prefix);
+    /*! The names of the functions in each loaded module that had
+     *  their bodies erased because of 'once' tags. */
+    std::map<llvm::Module *, std::set<std::string> > erased_functions;
 
 public:
     std::vector<std::string> *so_paths;
@@ -53,8 +56,17 @@ public:
 
     /*! Load the module from the specified path.
      *  @param path The path to the module.
+     *
+     *  Function bodies are not read until the module is
+     *  materialised.
      */
     llvm::Module *loadModule(std::string *path);
+    /*! Materialise all of the function bodies of a module.
+     *  @param module A module returned by loadModule.
+     *
+     *  This must be called before the module is linked.
+     */
+    void materializeModule(llvm::Module *module);
     /*! Load a dynamic library.
      *  @param path The path to the library.
      *  @param add_to_so_paths Whether the dynamic library should be
@@ -75,6 +87,17 @@ public:
     bool run(Context *ctx, llvm::Module *mod, Node *n,
              const char *module_name,
              std::vector<const char*> *import_forms);
+    /*! Open a file by way of the include directory paths.
+     *  @param path The path to the file.
+     *  @param path_buf Storage for the full path to the file.
+     *  @param mode The mode with which to open the file.
+     *
+     *  Each include directory path is tried in turn.  If the file
+     *  cannot be opened, then NULL is returned, and path_buf will
+     *  contain the last path that was tried.
+     */
+    FILE *openIncludeFile(const char *path, std::string *path_buf,
+                          const char *mode);
 };
 }
 }
@@ -2,6 +2,7 @@
 #include "Config.h"
 
 #include "../../Serialise/Serialise.h"
+#include "../../InstantiationMap/InstantiationMap.h"
 #include "../../Utils/Utils.h"
 
 namespace dale
@@ -38,9 +39,9 @@ Writer::writeBitcode(const char *suffix)
 
     FILE *bc = fopen(bc_path.c_str(), "w");
     if (!bc) {
-        char buf[1024];
-        sprintf(buf, "unable to open %s for writing", bc_path.c_str());
-        error(buf, true);
+        std::string msg("unable to open ");
+        msg.append(bc_path).append(" for writing");
+        error(msg.c_str(), true);
     }
 
     llvm::raw_fd_ostream bc_out(fileno(bc), false);
@@ -102,9 +103,9 @@ Writer::writeContext()
 
     FILE *mod_data = fopen(module_prefix.c_str(), "w");
     if (!mod_data) {
-        char buf[1024];
-        sprintf(buf, "unable to open %s for writing", module_prefix.c_str());
-        error(buf, true);
+        std::string msg("unable to open ");
+        msg.append(module_prefix).append(" for writing");
+        error(msg.c_str(), true);
     }
 
     assert(mod_data && "cannot create module file");
@@ -114,6 +115,10 @@ Writer::writeContext()
     serialise(mod_data, cto);
     serialise(mod_data, &dale_typemap);
 
+    HashMap<std::string> instantiations;
+    getLocalInstantiations(&instantiations);
+    serialise(mod_data, &instantiations);
+
     fflush(mod_data);
     fclose(mod_data);
 
@@ -4,11 +4,20 @@
 #include "../NativeTypes/NativeTypes.h"
 #include "../STL/STL.h"
 #include "../Utils/Utils.h"
+#include "../UndoLog/UndoLog.h"
 
+#include "llvm/Support/DynamicLibrary.h"
+
+#include <algorithm>
 #include <cstdio>
 
 namespace dale
 {
+BindingChanges Namespace::function_changes;
+BindingChanges Namespace::variable_changes;
+BindingChanges Namespace::struct_changes;
+BindingChanges Namespace::overload_changes;
+
 Namespace::Namespace()
 {
     this->parent_namespace = NULL;
@@ -55,7 +64,9 @@ Namespace::Namespace(ErrorReporter *er,
 
 Namespace::~Namespace()
 {
-    for (std::map<std::string, std::vector<Function*>*>::iterator
+    UndoLog::removeNamespace(this);
+
+    for (HashMap<std::vector<Function *> *>::iterator
             b = functions.begin(),
             e = functions.end();
             b != e;
@@ -96,13 +107,18 @@ Namespace::setNamespaces(std::vector<std::string> *namespaces)
 bool
 Namespace::addFunction(const char *name,
                        Function *function,
-                       Node *n)
+                       Node *n,
+                       bool *listed)
 {
-    std::map<std::string, std::vector<Function *>* >::iterator iter;
+    HashMap<std::vector<Function *> *>::iterator iter;
     std::vector<Function *>::iterator fn_iter;
     function->index = ++lv_index;
+    if (listed) {
+        *listed = true;
+    }
 
     std::string ss_name(name);
+    clearFunctionLookups(ss_name);
     iter = functions.find(ss_name);
 
     if (iter == functions.end()) {
@@ -115,11 +131,16 @@ Namespace::addFunction(const char *name,
                 ss_name, fns
             )
         );
+        UndoLog::addFunctionChange(this, name, fns, -1);
+        function_changes.add(ss_name);
 
         functions_ordered.push_back(function);
         return true;
     }
 
+    UndoLog::addFunctionChange(this, name, iter->second,
+                               iter->second->size());
+
     fn_iter = iter->second->begin();
     while (fn_iter != iter->second->end()) {
         Function *fn = (*fn_iter);
@@ -133,6 +154,9 @@ Namespace::addFunction(const char *name,
                     iter->second->erase(fn_iter);
                     fn_iter = iter->second->begin();
                 } else {
+                    if (listed) {
+                        *listed = false;
+                    }
                     functions_ordered.push_back(function);
                     return true;
                 }
@@ -178,7 +202,7 @@ bool
 Namespace::addVariable(const char *name,
                        Variable *variable)
 {
-    std::map<std::string, Variable *>::iterator iter;
+    HashMap<Variable *>::iterator iter;
     std::string ss_name(name);
 
     iter = variables.find(ss_name);
@@ -188,6 +212,8 @@ Namespace::addVariable(const char *name,
             std::pair<std::string, Variable *>(ss_name, variable)
         );
         variables_ordered.push_back(ss_name);
+        UndoLog::addBindingChange(UndoLog::VariableAdded, this);
+        variable_changes.add(ss_name);
         variable->index = ++lv_index;
         return true;
     } else {
@@ -199,7 +225,7 @@ bool
 Namespace::addStruct(const char *name,
                      Struct *element_struct)
 {
-    std::map<std::string, Struct *>::iterator iter;
+    HashMap<Struct *>::iterator iter;
     std::string ss_name(name);
 
     iter = structs.find(ss_name);
@@ -211,6 +237,8 @@ Namespace::addStruct(const char *name,
             )
         );
         structs_ordered.push_back(ss_name);
+        UndoLog::addBindingChange(UndoLog::StructAdded, this);
+        struct_changes.add(ss_name);
         return true;
     } else {
         return false;
@@ -221,7 +249,7 @@ bool
 Namespace::addEnum(const char *name,
                    Enum *element_enum)
 {
-    std::map<std::string, Enum *>::iterator iter;
+    HashMap<Enum *>::iterator iter;
     std::string ss_name(name);
 
     iter = enums.find(ss_name);
@@ -233,6 +261,7 @@ Namespace::addEnum(const char *name,
             )
         );
         enums_ordered.push_back(ss_name);
+        UndoLog::addBindingChange(UndoLog::EnumAdded, this);
         return true;
     } else {
         return false;
@@ -248,18 +277,14 @@ Namespace::getFunction(const char *name,
 {
     std::string ss_name(name);
 
-    std::map<std::string, std::vector<Function *> *>::iterator
-        iter = functions.find(ss_name);
-    if (iter == functions.end()) {
-        return NULL;
-    }
-
-    std::vector<Function *> *function_list = iter->second;
-    if (function_list->size() == 0) {
-        return NULL;
-    }
-
     if (!types) {
+        HashMap<std::vector<Function *> *>::iterator
+            iter = functions.find(ss_name);
+        if (iter == functions.end()) {
+            return NULL;
+        }
+
+        std::vector<Function *> *function_list = iter->second;
         Function *last_non_declaration = NULL;
 
         for (std::vector<Function *>::reverse_iterator
@@ -280,110 +305,218 @@ Namespace::getFunction(const char *name,
         return last_non_declaration;
     }
 
-    /* If types are provided, is_macro is only taken into account if
-     * it is true.  This is because you may want to get only the
-     * macros at a given point (the top-level), but there is no point
-     * at which you want prospective functions only. */
+    bool cacheable = true;
+    return lookupFunction(ss_name, types, pclosest_fn, is_macro,
+                          ignore_arg_constness, &cacheable);
+}
 
-    std::vector<Function *>::iterator fn_iter;
-    std::vector<Type *>::iterator arg_type_iter;
-    std::vector<Variable *>::iterator fn_arg_type_iter;
+Function *
+Namespace::lookupFunction(const std::string &name,
+                          std::vector<Type *> *types,
+                          Function **pclosest_fn,
+                          bool is_macro,
+                          bool ignore_arg_constness,
+                          bool *cacheable)
+{
+    HashMap<std::vector<Function *> *>::iterator
+        iter = functions.find(name);
+    if (iter == functions.end()) {
+        return NULL;
+    }
 
-    fn_iter = function_list->begin();
+    std::vector<Function *> *function_list = iter->second;
+    if (function_list->size() == 0) {
+        return NULL;
+    }
 
-    Function *best_va_fn = NULL;
-    int best_va_count = -1;
+    FunctionLookupKey key(*types, (is_macro ? 1 : 0)
+                                  | (ignore_arg_constness ? 2 : 0));
+    std::map<FunctionLookupKey, FunctionLookupResult> *lookups =
+        &(function_lookups[name]);
+    std::map<FunctionLookupKey, FunctionLookupResult>::iterator
+        cached = lookups->find(key);
+    if (cached != lookups->end()) {
+        if (!cached->second.fn && pclosest_fn) {
+            *pclosest_fn = cached->second.closest_fn;
+        }
+        return cached->second.fn;
+    }
 
-    Function *decl_fn    = NULL;
     Function *closest_fn = NULL;
-    int best_closest_count = -1;
-
-    while (fn_iter != function_list->end()) {
-        Function *current = (*fn_iter);
-        if (is_macro && !current->is_macro) {
-            ++fn_iter;
-            continue;
-        }
+    bool fn_cacheable = true;
+    Function *fn = findFunction(getOverloadSet(name, function_list),
+                                types, &closest_fn, is_macro,
+                                ignore_arg_constness, &fn_cacheable);
+    if (!fn && pclosest_fn) {
+        *pclosest_fn = closest_fn;
+    }
+    if (fn_cacheable) {
+        FunctionLookupResult result;
+        result.fn = fn;
+        result.closest_fn = closest_fn;
+        lookups->insert(std::make_pair(key, result));
+    } else {
+        *cacheable = false;
+    }
+    return fn;
+}
 
-        fn_arg_type_iter = current->parameters.begin();
-        arg_type_iter    = types->begin();
-        int matched_arg_count = 0;
-        bool broke_on_va      = false;
-        bool broke_on_failure = false;
-
-        /* If this is a macro, then increment the function's parameter
-         * types iterator, to account for the implicit MContext
-         * argument. */
-        if (current->is_macro) {
-            ++fn_arg_type_iter;
-        }
+OverloadSet *
+Namespace::getOverloadSet(const std::string &name,
+                          std::vector<Function *> *function_list)
+{
+    HashMap<OverloadSet>::iterator
+        iter = overload_sets.find(name);
+    if (iter != overload_sets.end()) {
+        return &(iter->second);
+    }
 
-        while (fn_arg_type_iter != current->parameters.end()) {
-            /* If the function's current parameter is varargs, then
-             * record the number of real arguments matched, keep a
-             * pointer to this function (if the number of matched
-             * arguments is better than that which is currently
-             * recorded), and go to the next function. */
-            if ((*fn_arg_type_iter)->type->base_type == BaseType::VarArgs) {
-                if (matched_arg_count > best_va_count) {
-                    best_va_count = matched_arg_count;
-                    best_va_fn = current;
-                    broke_on_va = true;
-                    break;
-                } else {
-                    broke_on_failure = true;
-                    break;
-                }
-            }
+    OverloadSet *overload_set = &(overload_sets[name]);
+    Type *pdnode = tr->type_pdnode;
 
-            if (arg_type_iter == types->end()) {
-                broke_on_failure = true;
+    for (std::vector<Function *>::iterator b = function_list->begin(),
+                                           e = function_list->end();
+            b != e;
+            ++b) {
+        Function *fn = (*b);
+        Overload overload;
+        overload.fn = fn;
+        overload.is_varargs = false;
+
+        std::vector<Variable *>::iterator
+            pb = fn->parameters.begin(),
+            pe = fn->parameters.end();
+        if (fn->is_macro) {
+            ++pb;
+        }
+        for (; pb != pe; ++pb) {
+            Type *type = (*pb)->type;
+            if (type->base_type == BaseType::VarArgs) {
+                overload.is_varargs = true;
                 break;
             }
+            overload.parameter_types.push_back(type);
+        }
 
-            bool result =
-                (*fn_arg_type_iter)->type->canBePassedFrom(
-                    (*arg_type_iter),
-                    ignore_arg_constness
-                );
-
-            if (result) {
-                ++arg_type_iter;
-                ++fn_arg_type_iter;
-                ++matched_arg_count;
-                continue;
-            } else {
-                broke_on_failure = true;
-                break;
-            }
+        int count = overload.parameter_types.size();
+        overload.pdnode_suffix = count;
+        while ((overload.pdnode_suffix > 0)
+                && overload.parameter_types[overload.pdnode_suffix - 1]
+                       ->canBePassedFrom(pdnode, true)) {
+            --overload.pdnode_suffix;
         }
 
-        if (!broke_on_failure && !broke_on_va
-                && (arg_type_iter == types->end())) {
-            /* If the function is a declaration, store it in decl_fn,
-             * to use in the event that the real function cannot be
-             * found. */
-            if (!current->llvm_function
-                    || (!current->llvm_function->size())) {
-                decl_fn = current;
-            } else {
-                return current;
-            }
+        int index = overload_set->all.size();
+        overload_set->all.push_back(overload);
+        if (overload.is_varargs) {
+            overload_set->varargs.push_back(index);
+        } else {
+            overload_set->by_arity[count].push_back(index);
         }
+    }
+
+    return overload_set;
+}
+
+/* Returns the number of leading arguments that can be passed to the
+ * overload's fixed parameters. */
+static int
+getLeadingMatchCount(Overload *overload, std::vector<Type *> *types,
+                     bool ignore_arg_constness)
+{
+    int limit = std::min(types->size(), overload->parameter_types.size());
+    int count = 0;
+    while ((count < limit)
+            && overload->parameter_types[count]->canBePassedFrom(
+                   (*types)[count], ignore_arg_constness)) {
+        ++count;
+    }
+    return count;
+}
 
-        if (broke_on_failure) {
-            if (matched_arg_count > best_closest_count) {
-                best_closest_count = matched_arg_count;
-                closest_fn = current;
+static bool
+hasBody(Function *fn)
+{
+    return (fn->llvm_function && fn->llvm_function->size());
+}
+
+Function *
+Namespace::findFunction(OverloadSet *overload_set,
+                        std::vector<Type *> *types,
+                        Function **pclosest_fn,
+                        bool is_macro,
+                        bool ignore_arg_constness,
+                        bool *cacheable)
+{
+    /* If types are provided, is_macro is only taken into account if
+     * it is true.  This is because you may want to get only the
+     * macros at a given point (the top-level), but there is no point
+     * at which you want prospective functions only. */
+
+    int arg_count = types->size();
+    std::vector<int> empty;
+    std::map<int, std::vector<int> >::iterator arity_iter =
+        overload_set->by_arity.find(arg_count);
+    std::vector<int> *fixed =
+        (arity_iter != overload_set->by_arity.end())
+            ? &(arity_iter->second)
+            : &empty;
+
+    /* Return the first exact match that has a body.  Failing that,
+     * return the varargs candidate that matches the most arguments,
+     * if one exists.  Otherwise, return the last declaration match,
+     * if one exists.  If a declaration match is found, then the
+     * result would change if that declaration were defined, so it is
+     * not cached. */
+
+    Function *decl_fn = NULL;
+    for (std::vector<int>::iterator b = fixed->begin(),
+                                    e = fixed->end();
+            b != e;
+            ++b) {
+        Overload *overload = &(overload_set->all[*b]);
+        Function *current = overload->fn;
+        if (is_macro && !current->is_macro) {
+            continue;
+        }
+        if (getLeadingMatchCount(overload, types, ignore_arg_constness)
+                != arg_count) {
+            continue;
+        }
+        if (hasBody(current)) {
+            if (decl_fn) {
+                *cacheable = false;
             }
+            return current;
         }
-        ++fn_iter;
+        decl_fn = current;
     }
 
-    /* If this part is reached, there was no exact match.  Return the
-     * best varargs candidate, if one exists.  Otherwise, return the
-     * declaration match, if one exists. */
+    Function *best_va_fn = NULL;
+    int best_va_count = -1;
+    for (std::vector<int>::iterator b = overload_set->varargs.begin(),
+                                    e = overload_set->varargs.end();
+            b != e;
+            ++b) {
+        Overload *overload = &(overload_set->all[*b]);
+        Function *current = overload->fn;
+        if (is_macro && !current->is_macro) {
+            continue;
+        }
+        int count = overload->parameter_types.size();
+        if ((count > arg_count) || (count <= best_va_count)) {
+            continue;
+        }
+        if (getLeadingMatchCount(overload, types, ignore_arg_constness)
+                == count) {
+            best_va_count = count;
+            best_va_fn = current;
+        }
+    }
 
+    if (decl_fn) {
+        *cacheable = false;
+    }
     if (best_va_fn) {
         return best_va_fn;
     } else if (decl_fn) {
@@ -391,48 +524,137 @@ Namespace::getFunction(const char *name,
     }
 
     /* If this part is reached, then set the closest function pointer,
-     * so that the callers can use it in an error message. */
+     * so that the callers can use it in an error message.  The
+     * closest function is the first one that matches the most
+     * arguments without matching all of them. */
 
     if (pclosest_fn) {
+        Function *closest_fn = NULL;
+        int best_closest_count = -1;
+        best_va_count = -1;
+        for (std::vector<Overload>::iterator
+                b = overload_set->all.begin(),
+                e = overload_set->all.end();
+                b != e;
+                ++b) {
+            Overload *overload = &(*b);
+            if (is_macro && !overload->fn->is_macro) {
+                continue;
+            }
+            int param_count = overload->parameter_types.size();
+            int count = getLeadingMatchCount(overload, types,
+                                             ignore_arg_constness);
+            bool failed;
+            if (count < param_count) {
+                failed = true;
+            } else if (overload->is_varargs) {
+                failed = (count <= best_va_count);
+                if (!failed) {
+                    best_va_count = count;
+                }
+            } else {
+                failed = false;
+            }
+            if (failed && (count > best_closest_count)) {
+                best_closest_count = count;
+                closest_fn = overload->fn;
+            }
+        }
         *pclosest_fn = closest_fn;
     }
 
     /* If the argument type list does not comprise (p DNode)s, then
-     * change the last argument to a (p DNode) and recall this
-     * function.  This is so as to find macro candidates which aren't
-     * an exact type match for the current arguments. */
-
-    Type *dnode = tr->getStructType("DNode");
-    Type *pdnode = tr->getPointerType(dnode);
-
-    std::vector<Type *>::reverse_iterator rb, re;
-    for (rb = types->rbegin(), re = types->rend(); rb != re; ++rb) {
-        Type *current_type = *rb;
-        if (!(current_type->isEqualTo(pdnode))) {
-            break;
-        }
-    }
+     * find the macro candidates which would match if the trailing
+     * arguments were (p DNode)s.  Each candidate is ranked by the
+     * position from which the arguments need to be replaced, and
+     * the candidates that require the fewest replacements are then
+     * treated as above. */
 
-    if (rb == re) {
+    Type *pdnode = tr->type_pdnode;
+
+    int last_cut = arg_count;
+    while ((last_cut > 0) && (*types)[last_cut - 1]->isEqualTo(pdnode)) {
+        --last_cut;
+    }
+    if (last_cut == 0) {
         return NULL;
     }
-
-    Type *substituted_type = (*rb);
-    (*rb) = pdnode;
-    Function *macro_candidate = getFunction(name, types, NULL, 1);
-    (*rb) = substituted_type;
-    if (macro_candidate) {
-        return macro_candidate;
+    --last_cut;
+
+    int best_cut = -1;
+    Function *body_fn = NULL;
+    decl_fn = NULL;
+    best_va_fn = NULL;
+    best_va_count = -1;
+
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<int> *indices =
+            (pass == 0) ? fixed : &(overload_set->varargs);
+        for (std::vector<int>::iterator b = indices->begin(),
+                                        e = indices->end();
+                b != e;
+                ++b) {
+            Overload *overload = &(overload_set->all[*b]);
+            Function *current = overload->fn;
+            if (!current->is_macro) {
+                continue;
+            }
+            int param_count = overload->parameter_types.size();
+            if (param_count > arg_count) {
+                continue;
+            }
+            int count = getLeadingMatchCount(overload, types, true);
+            int cut = ((count == param_count) && overload->is_varargs)
+                          ? last_cut
+                          : std::min(count, last_cut);
+            if (std::min(cut, param_count) < overload->pdnode_suffix) {
+                continue;
+            }
+            if (cut < best_cut) {
+                continue;
+            }
+            if (cut > best_cut) {
+                best_cut = cut;
+                body_fn = NULL;
+                decl_fn = NULL;
+                best_va_fn = NULL;
+                best_va_count = -1;
+            }
+            if (overload->is_varargs) {
+                if (param_count > best_va_count) {
+                    best_va_count = param_count;
+                    best_va_fn = current;
+                }
+            } else if (hasBody(current)) {
+                if (!body_fn) {
+                    body_fn = current;
+                    if (decl_fn) {
+                        *cacheable = false;
+                    }
+                }
+            } else if (!body_fn) {
+                decl_fn = current;
+            }
+        }
     }
 
-    return NULL;
+    if (body_fn) {
+        return body_fn;
+    }
+    if (decl_fn) {
+        *cacheable = false;
+    }
+    if (best_va_fn) {
+        return best_va_fn;
+    }
+    return decl_fn;
 }
 
 Variable *
 Namespace::getVariable(const char *name)
 {
     std::string ss_name(name);
-    std::map<std::string, Variable *>::iterator
+    HashMap<Variable *>::iterator
         iter = variables.find(ss_name);
     if (iter != variables.end()) {
         return iter->second;
@@ -444,7 +666,7 @@ Struct *
 Namespace::getStruct(const char *name)
 {
     std::string ss_name(name);
-    std::map<std::string, Struct *>::iterator
+    HashMap<Struct *>::iterator
         iter = structs.find(ss_name);
     if (iter != structs.end()) {
         return iter->second;
@@ -456,7 +678,7 @@ Enum *
 Namespace::getEnum(const char *name)
 {
     std::string ss_name(name);
-    std::map<std::string, Enum *>::iterator
+    HashMap<Enum *>::iterator
         iter = enums.find(ss_name);
     if (iter != enums.end()) {
         return iter->second;
@@ -493,7 +715,7 @@ void
 Namespace::getVarsBeforeIndex(int index,
                               std::vector<Variable *> *vars)
 {
-    for (std::map<std::string, Variable *>::iterator
+    for (HashMap<Variable *>::iterator
             b = variables.begin(),
             e = variables.end();
             b != e;
@@ -574,6 +796,8 @@ Namespace::functionNameToSymbol(const char *name,
 void
 Namespace::eraseLLVMMacros()
 {
+    clearFunctionLookups();
+
     std::vector<Function *>::reverse_iterator fn_b, fn_e;
 
     std::set<llvm::Function *> erased;
@@ -601,6 +825,8 @@ Namespace::eraseLLVMMacros()
 void
 Namespace::eraseLLVMMacrosAndCTOFunctions()
 {
+    clearFunctionLookups();
+
     std::vector<Function *>::reverse_iterator fn_b, fn_e;
 
     std::set<llvm::Function *> erased;
@@ -632,20 +858,26 @@ void
 Namespace::getFunctionNames(std::set<std::string> *names,
                             std::string *prefix)
 {
-    std::map<std::string, std::vector<Function*> *>::iterator
-        b, e;
-
     if (!prefix) {
-        for (b = functions.begin(), e = functions.end(); b != e; ++b) {
+        for (HashMap<std::vector<Function *> *>::iterator
+                b = functions.begin(),
+                e = functions.end();
+                b != e;
+                ++b) {
             names->insert(b->first);
         }
     } else {
-        b = functions.lower_bound(*prefix);
-        e = functions.end();
-        for (b = functions.lower_bound(*prefix), e = functions.end();
-                (b != e) && (b->first.find(*prefix) == 0);
+        if (sorted_function_names.empty()) {
+            functions.getSortedKeys(&sorted_function_names);
+        }
+        for (std::vector<std::string>::iterator
+                b = std::lower_bound(sorted_function_names.begin(),
+                                     sorted_function_names.end(),
+                                     *prefix),
+                e = sorted_function_names.end();
+                (b != e) && (b->find(*prefix) == 0);
                 ++b) {
-            names->insert(b->first);
+            names->insert(*b);
         }
     }
 }
@@ -664,7 +896,7 @@ Namespace::getVariables(std::vector<Variable *> *vars)
 }
 
 bool
-Namespace::merge(Namespace *other)
+Namespace::merge(Namespace *other, NewBindings *added)
 {
     assert(!name.compare(other->name) &&
            "merging namespaces with different names");
@@ -673,7 +905,7 @@ Namespace::merge(Namespace *other)
         lv_index = lv_index + 1;
     }
 
-    std::map<std::string, std::vector<Function *> *>::iterator
+    HashMap<std::vector<Function *> *>::iterator
         b, e;
 
     for (b = other->functions.begin(), e = other->functions.end();
@@ -688,13 +920,20 @@ Namespace::merge(Namespace *other)
             if (!Linkage::isExternAll(fn->linkage)) {
                 continue;
             }
-            bool added = addFunction(b->first.c_str(), fn, NULL);
-            assert(added && "unable to merge function");
-            _unused(added);
+            bool listed;
+            bool res = addFunction(b->first.c_str(), fn, NULL, &listed);
+            assert(res && "unable to merge function");
+            _unused(res);
+            if (added && listed) {
+                added->function_namespaces.insert(this);
+                added->functions.push_back(
+                    std::pair<std::string, Function *>(b->first, fn)
+                );
+            }
         }
     }
 
-    for (std::map<std::string, Enum*>::iterator
+    for (HashMap<Enum *>::iterator
             b = other->enums.begin(),
             e = other->enums.end();
             b != e;
@@ -705,12 +944,12 @@ Namespace::merge(Namespace *other)
         if (getEnum(b->first.c_str())) {
             continue;
         }
-        bool added = addEnum(b->first.c_str(), b->second);
-        assert(added && "unable to merge enum");
-        _unused(added);
+        bool res = addEnum(b->first.c_str(), b->second);
+        assert(res && "unable to merge enum");
+        _unused(res);
     }
 
-    for (std::map<std::string, Variable*>::iterator
+    for (HashMap<Variable *>::iterator
             b = other->variables.begin(),
             e = other->variables.end();
             b != e;
@@ -721,12 +960,15 @@ Namespace::merge(Namespace *other)
         if (getVariable(b->first.c_str())) {
             continue;
         }
-        bool added = addVariable(b->first.c_str(), b->second);
-        assert(added && "unable to merge variable");
-        _unused(added);
+        bool res = addVariable(b->first.c_str(), b->second);
+        assert(res && "unable to merge variable");
+        _unused(res);
+        if (added) {
+            added->variables.push_back(*b);
+        }
     }
 
-    for (std::map<std::string, Struct*>::iterator
+    for (HashMap<Struct *>::iterator
             b = other->structs.begin(),
             e = other->structs.end();
             b != e;
@@ -737,83 +979,162 @@ Namespace::merge(Namespace *other)
         if (getStruct(b->first.c_str())) {
             continue;
         }
-        bool added = addStruct(b->first.c_str(), b->second);
-        assert(added && "unable to merge struct");
-        _unused(added);
+        bool res = addStruct(b->first.c_str(), b->second);
+        assert(res && "unable to merge struct");
+        _unused(res);
+        if (added) {
+            added->structs.push_back(b->second);
+        }
     }
 
     return true;
 }
 
+void
+Namespace::getBindings(NewBindings *added)
+{
+    for (HashMap<std::vector<Function *> *>::iterator
+            b = functions.begin(),
+            e = functions.end();
+            b != e;
+            ++b) {
+        for (std::vector<Function *>::iterator
+                fb = b->second->begin(),
+                fe = b->second->end();
+                fb != fe;
+                ++fb) {
+            added->functions.push_back(
+                std::pair<std::string, Function *>(b->first, *fb)
+            );
+        }
+    }
+    added->function_namespaces.insert(this);
+
+    for (HashMap<Variable *>::iterator
+            b = variables.begin(),
+            e = variables.end();
+            b != e;
+            ++b) {
+        added->variables.push_back(*b);
+    }
+
+    for (HashMap<Struct *>::iterator
+            b = structs.begin(),
+            e = structs.end();
+            b != e;
+            ++b) {
+        added->structs.push_back(b->second);
+    }
+}
+
 bool
 Namespace::regetStructPointers(llvm::Module *mod)
 {
-    for (std::map<std::string, Struct *>::iterator
+    for (HashMap<Struct *>::iterator
             b = structs.begin(),
             e = structs.end();
             b != e;
             ++b) {
-        Struct *st = b->second;
-        if (!st->internal_name.compare("")) {
-            continue;
-        }
-        std::string type_name;
-        type_name.append("struct_")
-                 .append(st->internal_name);
-
-        llvm::StructType *llvm_st = mod->getTypeByName(type_name);
-        if (!llvm_st) {
-            type_name.clear();
-            type_name.append(st->internal_name);
-            llvm_st = mod->getTypeByName(type_name);
-        }
-        assert(llvm_st && "could not get type for struct");
-        st->type = llvm_st;
+        regetStructPointer(b->second, mod);
     }
 
     return true;
 }
 
+bool
+Namespace::regetStructPointer(Struct *st, llvm::Module *mod)
+{
+    if (!st->internal_name.compare("")) {
+        return true;
+    }
+    std::string type_name;
+    type_name.append("struct_")
+             .append(st->internal_name);
+
+    llvm::StructType *llvm_st = mod->getTypeByName(type_name);
+    if (!llvm_st) {
+        type_name.clear();
+        type_name.append(st->internal_name);
+        llvm_st = mod->getTypeByName(type_name);
+    }
+    assert(llvm_st && "could not get type for struct");
+    st->type = llvm_st;
+
+    return true;
+}
+
 bool
 Namespace::regetVariablePointers(llvm::Module *mod)
 {
-    for (std::map<std::string, Variable *>::iterator
+    for (HashMap<Variable *>::iterator
             b = variables.begin(),
             e = variables.end();
             b != e;
             ++b) {
-        Variable *var = b->second;
-        /* internal_name is only set when the variable's value pointer
-         * needs to be updated on merge.  */
-        std::string *in = &(var->internal_name);
-        if (!(in && in->size())) {
-            continue;
-        }
-        if (!var->value) {
-            /* Can't get type if there is no llvm::Value for this
-             * value. In that case, the variable's status becomes the
-             * responsibility of the caller. */
-            continue;
-        }
-        var->value =
-            llvm::cast<llvm::Value>(
-                mod->getOrInsertGlobal(
-                    in->c_str(),
-                    llvm::cast<llvm::PointerType>(
-                        var->value->getType()
-                    )->getElementType()
-                )
-            );
-        assert(var->value && "unable to re-get global variable");
+        regetVariablePointer(b->second, mod);
     }
 
     return true;
 }
 
+bool
+Namespace::regetVariablePointer(Variable *var, llvm::Module *mod)
+{
+    /* internal_name is only set when the variable's value pointer
+     * needs to be updated on merge.  */
+    std::string *in = &(var->internal_name);
+    if (!(in && in->size())) {
+        return true;
+    }
+    if (!var->value) {
+        /* Can't get type if there is no llvm::Value for this
+         * value. In that case, the variable's status becomes the
+         * responsibility of the caller. */
+        return true;
+    }
+    var->value =
+        llvm::cast<llvm::Value>(
+            mod->getOrInsertGlobal(
+                in->c_str(),
+                llvm::cast<llvm::PointerType>(
+                    var->value->getType()
+                )->getElementType()
+            )
+        );
+    assert(var->value && "unable to re-get global variable");
+
+    return true;
+}
+
+void
+Namespace::bindNativeMacro(Function *fn)
+{
+    if (!fn->is_macro || !fn->llvm_function) {
+        return;
+    }
+    if (!fn->llvm_function->isDeclaration()) {
+        return;
+    }
+    if (fn->macro_fptr
+            && (fn->macro_fptr_llvm_function == fn->llvm_function)) {
+        return;
+    }
+    void *fptr =
+        llvm::sys::DynamicLibrary::SearchForAddressOfSymbol(
+            fn->internal_name.c_str()
+        );
+    if (fptr) {
+        fn->macro_fptr = fptr;
+        fn->macro_fptr_llvm_function = fn->llvm_function;
+    }
+}
+
 bool
 Namespace::regetFunctionPointers(llvm::Module *mod)
 {
-    std::map<std::string, std::vector<Function *>* >::iterator
+    clearFunctionLookups();
+
+    HashMap<std::vector<Function *> *>::iterator
         b, e;
 
     for (b = functions.begin(), e = functions.end(); b != e; ++b) {
@@ -842,9 +1163,12 @@ Namespace::regetPointers(llvm::Module *mod)
 
 bool
 Namespace::eraseOnceFunctions(std::set<std::string> *once_tags,
-                              llvm::Module *mod)
+                              llvm::Module *mod,
+                              std::set<std::string> *erased)
 {
-    std::map<std::string, std::vector<Function*> *>::iterator
+    clearFunctionLookups();
+
+    HashMap<std::vector<Function *> *>::iterator
         b, e;
 
     for (b = functions.begin(), e = functions.end(); b != e; ++b) {
@@ -862,6 +1186,7 @@ Namespace::eraseOnceFunctions(std::set<std::string> *once_tags,
                     mod->getFunction(fn->internal_name.c_str());
                 if (fn_to_remove) {
                     fn_to_remove->deleteBody();
+                    erased->insert(fn->internal_name);
                 }
             }
         }
@@ -874,7 +1199,7 @@ bool
 Namespace::eraseOnceVariables(std::set<std::string> *once_tags,
                               llvm::Module *mod)
 {
-    for (std::map<std::string, Variable*>::iterator
+    for (HashMap<Variable *>::iterator
             b = variables.begin(),
             e = variables.end();
             b != e;
@@ -900,7 +1225,9 @@ bool
 Namespace::removeUnneededStructs(std::set<std::string> *forms,
                                  std::set<std::string> *found_forms)
 {
-    std::map<std::string, Struct *>::iterator
+    struct_changes.addAll();
+
+    HashMap<Struct *>::iterator
         b = structs.begin(),
         e = structs.end();
     while (b != e) {
@@ -922,7 +1249,7 @@ bool
 Namespace::removeUnneededEnums(std::set<std::string> *forms,
                                std::set<std::string> *found_forms)
 {
-    std::map<std::string, Enum *>::iterator
+    HashMap<Enum *>::iterator
         b = enums.begin(),
         e = enums.end();
 
@@ -945,7 +1272,9 @@ bool
 Namespace::removeUnneededVariables(std::set<std::string> *forms,
                                    std::set<std::string> *found_forms)
 {
-    std::map<std::string, Variable *>::iterator
+    variable_changes.addAll();
+
+    HashMap<Variable *>::iterator
         b = variables.begin(),
         e = variables.end();
 
@@ -968,7 +1297,9 @@ bool
 Namespace::removeUnneededFunctions(std::set<std::string> *forms,
                                    std::set<std::string> *found_forms)
 {
-    std::map<std::string, std::vector<Function*> *>::iterator
+    clearFunctionLookups();
+
+    HashMap<std::vector<Function *> *>::iterator
         b = functions.begin(),
         e = functions.end();
 
@@ -1003,8 +1334,12 @@ Namespace::removeUnneededFunctions(std::set<std::string> *forms,
 bool
 Namespace::removeDeserialised()
 {
+    clearFunctionLookups();
+    variable_changes.addAll();
+    struct_changes.addAll();
+
     {
-        std::map<std::string, Variable *>::iterator
+        HashMap<Variable *>::iterator
             b = variables.begin(),
             e = variables.end();
 
@@ -1018,7 +1353,7 @@ Namespace::removeDeserialised()
     }
 
     {
-        std::map<std::string, Struct *>::iterator
+        HashMap<Struct *>::iterator
             b = structs.begin(),
             e = structs.end();
 
@@ -1032,7 +1367,7 @@ Namespace::removeDeserialised()
     }
 
     {
-        std::map<std::string, Enum *>::iterator
+        HashMap<Enum *>::iterator
             b = enums.begin(),
             e = enums.end();
 
@@ -1045,7 +1380,7 @@ Namespace::removeDeserialised()
         }
     }
 
-    std::map<std::string, std::vector<Function*> *>::iterator
+    HashMap<std::vector<Function *> *>::iterator
         fb = functions.begin(),
         fe = functions.end();
 
@@ -1078,6 +1413,25 @@ Namespace::removeUnneeded(std::set<std::string> *forms,
     return true;
 }
 
+void
+Namespace::clearFunctionLookups(const std::string &name)
+{
+    function_lookups.erase(name);
+    overload_sets.erase(name);
+    sorted_function_names.clear();
+    overload_changes.add(name);
+}
+
+void
+Namespace::clearFunctionLookups()
+{
+    function_lookups.clear();
+    overload_sets.clear();
+    sorted_function_names.clear();
+    function_changes.addAll();
+    overload_changes.addAll();
+}
+
 void
 Namespace::print()
 {
@@ -1088,7 +1442,7 @@ Namespace::print()
                         ? parent_namespace->name.c_str()
                         : "(nil)");
 
-    for (std::map<std::string, std::vector<Function*>*>::iterator
+    for (HashMap<std::vector<Function *> *>::iterator
             b = functions.begin(),
             e = functions.end();
             b != e;
@@ -1097,21 +1451,21 @@ Namespace::print()
                         b->first.c_str(),
                         b->second->size());
     }
-    for (std::map<std::string, Struct *>::iterator
+    for (HashMap<Struct *>::iterator
             b = structs.begin(),
             e = structs.end();
             b != e;
             ++b) {
         fprintf(stderr, "Struct: %s\n", b->first.c_str());
     }
-    for (std::map<std::string, Enum *>::iterator
+    for (HashMap<Enum *>::iterator
             b = enums.begin(),
             e = enums.end();
             b != e;
             ++b) {
         fprintf(stderr, "Enum: %s\n", b->first.c_str());
     }
-    for (std::map<std::string, Variable *>::iterator
+    for (HashMap<Variable *>::iterator
             b = variables.begin(),
             e = variables.end();
             b != e;
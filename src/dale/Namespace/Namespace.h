@@ -12,13 +12,113 @@
 #include "../NativeTypes/NativeTypes.h"
 #include "../TypeRegister/TypeRegister.h"
 #include "../STL/STL.h"
+#include "../HashMap/HashMap.h"
 
 #include <vector>
 #include <string>
 #include <map>
+#include <set>
 
 namespace dale
 {
+/*! The key for a cached function lookup: the argument types, and a
+ *  set of flags for the other lookup arguments. */
+typedef std::pair<std::vector<Type *>, int> FunctionLookupKey;
+
+/*! The result of a cached function lookup. */
+struct FunctionLookupResult
+{
+    Function *fn;
+    Function *closest_fn;
+};
+
+/*! A function in an overload set, with the details needed to match
+ *  it against a list of argument types. */
+struct Overload
+{
+    Function *fn;
+    /*! The types of the function's fixed parameters, excluding the
+     *  implicit macro context parameter. */
+    std::vector<Type *> parameter_types;
+    /*! Whether the function takes a variable number of arguments. */
+    bool is_varargs;
+    /*! The index of the first fixed parameter from which every
+     *  subsequent fixed parameter accepts a (p DNode). */
+    int pdnode_suffix;
+};
+
+/*! The functions for a single name.  The overloads are stored in
+ *  order of addition, and are also bucketed by the number of fixed
+ *  parameters, with varargs functions in a bucket of their own. */
+struct OverloadSet
+{
+    std::vector<Overload> all;
+    std::map<int, std::vector<int> > by_arity;
+    std::vector<int> varargs;
+};
+
+/*! A record of changes to the set of names bound by a particular
+ *  kind of binding, across all namespaces.  This is used to
+ *  invalidate caches of visible bindings (see Context) and of probe
+ *  results (see Introspection).  The generation is incremented on
+ *  each change.  The name is that of the binding affected by the most
+ *  recent change, or is empty if that change may have affected any
+ *  name.  The generation of the most recent change to each name, and
+ *  of the most recent change that may have affected any name, are
+ *  also recorded. */
+struct BindingChanges
+{
+    int generation;
+    std::string name;
+    int all_generation;
+    HashMap<int> name_generations;
+
+    BindingChanges() : generation(0), all_generation(0) {}
+
+    void
+    add(const std::string &changed_name)
+    {
+        ++generation;
+        name = changed_name;
+        name_generations[changed_name] = generation;
+    }
+
+    void
+    addAll()
+    {
+        ++generation;
+        name.clear();
+        all_generation = generation;
+    }
+
+    /*! Get the generation of the most recent change that may have
+     *  affected the given name. */
+    int
+    getGeneration(const std::string &changed_name)
+    {
+        HashMap<int>::iterator b = name_generations.find(changed_name);
+        if ((b == name_generations.end())
+                || (b->second < all_generation)) {
+            return all_generation;
+        }
+        return b->second;
+    }
+};
+
+/*! The bindings added by way of a merge (see Namespace::merge and
+ *  Context::merge).  Only these bindings need their LLVM pointers to
+ *  be refetched after merging a new module's context. */
+struct NewBindings
+{
+    /*! The namespaces to which functions were added. */
+    std::set<Namespace *> function_namespaces;
+    /*! The added functions, with their names. */
+    std::vector<std::pair<std::string, Function *> > functions;
+    /*! The added variables, with their names. */
+    std::vector<std::pair<std::string, Variable *> > variables;
+    /*! The added structs. */
+    std::vector<Struct *> structs;
+};
 
 /*! Namespace
 
@@ -45,13 +145,13 @@ public:
     /*! A map from function name to function list. The list is
      *  necessary because functions may be overloaded. Note that both
      *  macros and functions are stored in this map.*/
-    std::map<std::string, std::vector<Function *>* > functions;
+    HashMap<std::vector<Function *> *> functions;
     /*! A map from variable name to variable. */
-    std::map<std::string, Variable *> variables;
+    HashMap<Variable *> variables;
     /*! A map from struct name to struct. */
-    std::map<std::string, Struct *> structs;
+    HashMap<Struct *> structs;
     /*! A map from enum name to enum. */
-    std::map<std::string, Enum *> enums;
+    HashMap<Enum *> enums;
     /*! The functions in order of addition. */
     std::vector<Function *> functions_ordered;
     /*! The variable names in order of addition. */
@@ -84,6 +184,17 @@ public:
      *  for all others. */
     bool has_symbol_prefix;
 
+    /*! Changes to the function names bound in any namespace. */
+    static BindingChanges function_changes;
+    /*! Changes to the variable names bound in any namespace. */
+    static BindingChanges variable_changes;
+    /*! Changes to the struct names bound in any namespace. */
+    static BindingChanges struct_changes;
+    /*! Changes to the function lists in any namespace.  Unlike
+     *  function_changes, this includes the addition of overloads for
+     *  names that are already bound. */
+    static BindingChanges overload_changes;
+
     /*! The void constructor, intended solely for use by the
      *  deserialisation procedures. */
     Namespace();
@@ -106,14 +217,19 @@ public:
      *  @param name The bare name of the function.
      *  @param function The function object.
      *  @param n The function's node, for error-reporting purposes.
+     *  @param listed Set to whether the function object itself is in
+     *                the namespace's list for the name on success
+     *                (optional).
      *
      *  This will report an error and return false when the function
      *  has the same parameter types as an existing function within
-     *  this namespace.
+     *  this namespace.  If an equivalent defined function is already
+     *  present, then the function is not added to the list.
      */
     bool addFunction(const char *name,
                      Function *function,
-                     Node *n);
+                     Node *n,
+                     bool *listed = NULL);
     /*! Add a variable to the namespace.
      *  @param name The bare name of the variable.
      *  @param variable The variable object. */
@@ -230,6 +346,18 @@ public:
      *  been marked as compile-time only.
      */
     void eraseLLVMMacrosAndCTOFunctions();
+    /*! Bind a macro to its native implementation.
+     *  @param fn The function.
+     *
+     *  If the function is a macro whose LLVM function is only a
+     *  declaration, look up the macro's symbol in the loaded
+     *  libraries.  If it is found, it is used as the macro's function
+     *  pointer, so that the macro does not need to be compiled before
+     *  it is called.  This is used by the module reader for the
+     *  macros added by a module, after the module's shared object has
+     *  been loaded.
+     */
+    static void bindNativeMacro(Function *fn);
 
     /*! Set the namespace names for the current namespace.
      *  @param namespaces A vector to which the namespace names will be added.
@@ -248,8 +376,17 @@ public:
      *  the current namespace. Note that the two namespaces must have
      *  the same name, but this does not check the parent namespaces'
      *  names (it's just a simple sanity check).
+     *  @param added An optional object for recording the bindings
+     *  that were added to this namespace.
      */
-    bool merge(Namespace *other);
+    bool merge(Namespace *other, NewBindings *added);
+    /*! Record all of this namespace's bindings as new bindings.
+     *  @param added The object for recording the bindings.
+     *
+     *  This is for namespaces that are added to a context as a
+     *  whole by way of a merge.
+     */
+    void getBindings(NewBindings *added);
 
     /*! Reget all structs' LLVM types from the module.
      *  @param mod The module from which the type should be reloaded.
@@ -258,6 +395,11 @@ public:
      *  module.
      */
     bool regetStructPointers(llvm::Module *mod);
+    /*! Reget a single struct's LLVM type from the module.
+     *  @param st The struct.
+     *  @param mod The module from which the type should be reloaded.
+     */
+    static bool regetStructPointer(Struct *st, llvm::Module *mod);
     /*! Reget all variables' LLVM values from the module.
      *  @param mod The module from which the value should be reloaded.
      *
@@ -267,6 +409,13 @@ public:
      *  value cannot be got or inserted.
      */
     bool regetVariablePointers(llvm::Module *mod);
+    /*! Reget a single variable's LLVM value from the module.
+     *  @param var The variable.
+     *  @param mod The module from which the value should be reloaded.
+     *
+     *  See regetVariablePointers.
+     */
+    static bool regetVariablePointer(Variable *var, llvm::Module *mod);
     /*! Reget all functions' LLVM functions from the module.
      *  @param mod The module from which the function should be reloaded.
      *
@@ -284,6 +433,8 @@ public:
     /*! Erase LLVM function bodies for functions with a given 'once' tag.
      *  @param once_tags The current set of 'once' tags.
      *  @param mod The LLVM module to use for erasure.
+     *  @param erased A set to which the names of erased functions
+     *                are added.
      *
      *  This does not remove the functions that have one of the
      *  specified 'once' tags from the namespace: it just deletes the
@@ -291,7 +442,8 @@ public:
      *  declaration.
      */
     bool eraseOnceFunctions(std::set<std::string> *once_tags,
-                            llvm::Module *mod);
+                            llvm::Module *mod,
+                            std::set<std::string> *erased);
     /*! Erase LLVM variable values for variables with a given 'once' tag.
      *  @param once_tags The current set of 'once' tags.
      *  @param mod The LLVM module to use for erasure.
@@ -343,6 +495,46 @@ public:
 
     /*! Print the namespace's details to stderr. */
     void print();
+
+    /*! Clear the cached function lookups for a single name.
+     *  @param name The function name.
+     *
+     *  This must be called whenever the list of functions for the
+     *  name is changed other than through addFunction.
+     */
+    void clearFunctionLookups(const std::string &name);
+    /*! Clear all cached function lookups. */
+    void clearFunctionLookups();
+
+private:
+    /*! Cached function lookups, by function name.  Only lookups
+     *  whose results cannot be changed by function bodies being
+     *  defined are cached. */
+    HashMap<std::map<FunctionLookupKey, FunctionLookupResult> >
+        function_lookups;
+    /*! Overload sets, by function name.  These are built on first
+     *  lookup, and cleared along with the cached lookups. */
+    HashMap<OverloadSet> overload_sets;
+    /*! The function names in sorted order, for prefix searches.
+     *  This is built on demand, and cleared along with the cached
+     *  lookups. */
+    std::vector<std::string> sorted_function_names;
+
+    OverloadSet *getOverloadSet(const std::string &name,
+                                std::vector<Function *> *function_list);
+
+    Function *lookupFunction(const std::string &name,
+                             std::vector<Type *> *types,
+                             Function **pclosest_fn,
+                             bool is_macro,
+                             bool ignore_arg_constness,
+                             bool *cacheable);
+    Function *findFunction(OverloadSet *overload_set,
+                           std::vector<Type *> *types,
+                           Function **pclosest_fn,
+                           bool is_macro,
+                           bool ignore_arg_constness,
+                           bool *cacheable);
 };
 }
 
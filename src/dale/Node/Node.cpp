@@ -1,10 +1,12 @@
 #include "Node.h"
 
 #include "../Utils/Utils.h"
+#include "../DNodeArena/DNodeArena.h"
 
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <set>
 
 namespace dale
 {
@@ -40,12 +42,21 @@ Node::~Node()
     if (is_token) {
         delete token;
     } else if (is_list) {
-        for (std::vector<Node *>::iterator b = list->begin(),
-                                           e = list->end();
-                b != e; ++b) {
-            delete (*b);
-        }
+        /* Detach each list before deleting its node, so that deeply
+         * nested lists do not lead to deeply nested destructor
+         * calls. */
+        std::vector<Node *> pending(list->begin(), list->end());
         delete list;
+        while (!pending.empty()) {
+            Node *node = pending.back();
+            pending.pop_back();
+            if (node && node->is_list) {
+                pending.insert(pending.end(), node->list->begin(),
+                               node->list->end());
+                node->list->clear();
+            }
+            delete node;
+        }
     }
 }
 
@@ -122,14 +133,8 @@ Node::copyTo(Node *other)
 void
 Node::copyMetaTo(Node *other)
 {
-    other->list_begin.setLineAndColumn(
-        getBeginPos()->getLineNumber(),
-        getBeginPos()->getColumnNumber()
-    );
-    other->list_end.setLineAndColumn(
-        getEndPos()->getLineNumber(),
-        getEndPos()->getColumnNumber()
-    );
+    getBeginPos()->copyTo(&(other->list_begin));
+    getEndPos()->copyTo(&(other->list_end));
     other->macro_begin = macro_begin;
     other->macro_end = macro_end;
     other->filename = filename;
@@ -146,109 +151,155 @@ nullNode()
     return null_node;
 }
 
-DNode *
-Node::toDNode()
+void
+deleteNodeTrees(std::vector<Node *> *roots)
 {
-    if (is_token) {
-        Token *t = token;
-        DNode *dnode = (DNode*) malloc(sizeof(*dnode));
-        if (!dnode) {
-            error("unable to allocate memory", true);
+    std::set<Node *> seen;
+    std::vector<Node *> pending(roots->begin(), roots->end());
+
+    while (!pending.empty()) {
+        Node *node = pending.back();
+        pending.pop_back();
+        if (!node || (node == null_node)) {
+            continue;
+        }
+        if (!seen.insert(node).second) {
+            continue;
+        }
+        if (node->is_list) {
+            pending.insert(pending.end(), node->list->begin(),
+                           node->list->end());
+        }
+    }
+
+    for (std::set<Node *>::iterator b = seen.begin(),
+                                    e = seen.end();
+            b != e;
+            ++b) {
+        Node *node = (*b);
+        if (node->is_list) {
+            node->list->clear();
         }
+        delete node;
+    }
+}
+
+static DNode *
+nodeToShallowDNode(Node *node, DNodeArena *arena)
+{
+    if (!node->is_token && !node->is_list) {
+        return NULL;
+    }
+
+    DNode *dnode =
+        (arena) ? (DNode *) arena->allocate(sizeof(*dnode))
+                : (DNode *) malloc(sizeof(*dnode));
+    if (!dnode) {
+        error("unable to allocate memory", true);
+    }
 
+    if (node->is_token) {
+        /* The token string is always copied, since macros may
+         * modify DNode token strings in place. */
         std::string token_str;
-        t->toString(&token_str);
+        node->token->toString(&token_str);
 
-        char *sv = (char *) malloc(token_str.length() + 1);
+        char *sv = (arena) ? (char *) arena->allocate(token_str.length() + 1)
+                           : (char *) malloc(token_str.length() + 1);
         if (!sv) {
             error("unable to allocate memory", true);
         }
-        strncpy(sv, token_str.c_str(), token_str.length() + 1);
+        memcpy(sv, token_str.c_str(), token_str.length() + 1);
 
         dnode->is_list   = false;
         dnode->token_str = sv;
-        dnode->list_node = NULL;
-        dnode->next_node = NULL;
-
-        dnode->begin_line   = getBeginPos()->getLineNumber();
-        dnode->begin_column = getBeginPos()->getColumnNumber();
-        dnode->end_line     = getEndPos()->getLineNumber();
-        dnode->end_column   = getEndPos()->getColumnNumber();
-        if (macro_begin.getLineNumber()) {
-            dnode->macro_begin_line   = macro_begin.getLineNumber();
-            dnode->macro_begin_column = macro_begin.getColumnNumber();
-            dnode->macro_end_line     = macro_end.getLineNumber();
-            dnode->macro_end_column   = macro_end.getColumnNumber();
-        }
-        dnode->filename = filename;
+    } else {
+        dnode->is_list   = true;
+        dnode->token_str = NULL;
+    }
+    dnode->list_node = NULL;
+    dnode->next_node = NULL;
 
-        return dnode;
-    } else if (is_list) {
-        DNode *top_node = (DNode*) malloc(sizeof(*top_node));
-        if (!top_node) {
-            error("unable to allocate memory", true);
+    dnode->begin_location       = node->getBeginPos()->getLocation();
+    dnode->end_location         = node->getEndPos()->getLocation();
+    dnode->macro_begin_location = node->macro_begin.getLocation();
+    dnode->macro_end_location   = node->macro_end.getLocation();
+
+    dnode->filename = node->filename;
+
+    if (arena) {
+        arena->addOrigin(node, dnode);
+    }
+
+    return dnode;
+}
+
+DNode *
+Node::toDNode(DNodeArena *arena)
+{
+    DNode *top_dnode = nodeToShallowDNode(this, arena);
+    if (!top_dnode) {
+        return NULL;
+    }
+
+    std::vector<std::pair<Node *, DNode *> > pending;
+    pending.push_back(std::make_pair(this, top_dnode));
+
+    while (!pending.empty()) {
+        Node *node   = pending.back().first;
+        DNode *dnode = pending.back().second;
+        pending.pop_back();
+
+        if (!node->is_list) {
+            continue;
         }
-        top_node->is_list   = true;
-        top_node->token_str = NULL;
-        top_node->next_node = NULL;
 
         DNode *current_dnode = NULL;
-
-        std::vector<Node*> *lst = list;
-        for (std::vector<Node *>::iterator b = lst->begin(),
-                                           e = lst->end();
+        for (std::vector<Node *>::iterator b = node->list->begin(),
+                                           e = node->list->end();
                 b != e;
                 ++b) {
-            DNode *lst_dnode = (*b)->toDNode();
+            DNode *lst_dnode = nodeToShallowDNode(*b, arena);
+            if (!lst_dnode) {
+                continue;
+            }
             if (!current_dnode) {
-                top_node->list_node      = lst_dnode;
-                current_dnode            = lst_dnode;
+                dnode->list_node         = lst_dnode;
             } else {
                 current_dnode->next_node = lst_dnode;
-                current_dnode            = lst_dnode;
             }
+            current_dnode = lst_dnode;
+            pending.push_back(std::make_pair(*b, lst_dnode));
         }
-
-        top_node->begin_line   = getBeginPos()->getLineNumber();
-        top_node->begin_column = getBeginPos()->getColumnNumber();
-        top_node->end_line     = getEndPos()->getLineNumber();
-        top_node->end_column   = getEndPos()->getColumnNumber();
-
-        if (macro_begin.getLineNumber()) {
-            top_node->macro_begin_line   = macro_begin.getLineNumber();
-            top_node->macro_begin_column = macro_begin.getColumnNumber();
-            top_node->macro_end_line     = macro_end.getLineNumber();
-            top_node->macro_end_column   = macro_end.getColumnNumber();
-        }
-        top_node->filename = filename;
-
-        return top_node;
     }
 
-    return NULL;
+    return top_dnode;
 }
 
 void
 Node::addMacroPosition(Node *mp_node)
 {
-    if (!(macro_begin.getLineNumber())) {
-        macro_begin.setLineAndColumn(
-            mp_node->getBeginPos()->getLineNumber(),
-            mp_node->getBeginPos()->getColumnNumber()
-        );
-        macro_end.setLineAndColumn(
-            mp_node->getEndPos()->getLineNumber(),
-            mp_node->getEndPos()->getColumnNumber()
-        );
-    }
+    Position *begin = mp_node->getBeginPos();
+    Position *end   = mp_node->getEndPos();
 
-    if (is_list) {
-        for (std::vector<Node *>::iterator
-                b = list->begin(),
-                e = list->end();
-                b != e;
-                ++b) {
-            (*b)->addMacroPosition(mp_node);
+    std::vector<Node *> pending;
+    pending.push_back(this);
+
+    while (!pending.empty()) {
+        Node *node = pending.back();
+        pending.pop_back();
+        if (!node) {
+            continue;
+        }
+
+        if (!(node->macro_begin.isSet())) {
+            begin->copyTo(&(node->macro_begin));
+            end->copyTo(&(node->macro_end));
+        }
+
+        if (node->is_list) {
+            pending.insert(pending.end(), node->list->begin(),
+                           node->list->end());
         }
     }
 
@@ -270,4 +321,32 @@ Node::init()
     macro_begin.zero();
     macro_end.zero();
 }
+
+void
+appendNodeKey(Node *node, std::string *key)
+{
+    std::vector<Node *> pending;
+    pending.push_back(node);
+
+    while (!pending.empty()) {
+        Node *current = pending.back();
+        pending.pop_back();
+
+        if (!current) {
+            key->push_back(')');
+        } else if (current->is_token) {
+            std::string token_str;
+            current->token->toString(&token_str);
+            char length_buf[32];
+            sprintf(length_buf, "%u:", (unsigned) token_str.length());
+            key->append(length_buf);
+            key->append(token_str);
+        } else if (current->is_list) {
+            key->push_back('(');
+            pending.push_back(NULL);
+            pending.insert(pending.end(), current->list->rbegin(),
+                           current->list->rend());
+        }
+    }
+}
 }
@@ -5,12 +5,14 @@
 #include "../Position/Position.h"
 
 #include <vector>
+#include <string>
 
 /*! DNode
 
     The struct analogue to Node.  This must have the same definition
     as the DNode type defined in the drt module, so that DNodes may be
-    passed between the compiler and Dale code.
+    passed between the compiler and Dale code.  The positions are
+    encoded locations: see Position.
 */
 struct DNode
 {
@@ -18,19 +20,17 @@ struct DNode
     char *token_str;
     DNode *list_node;
     DNode *next_node;
-    int begin_line;
-    int begin_column;
-    int end_line;
-    int end_column;
-    int macro_begin_line;
-    int macro_begin_column;
-    int macro_end_line;
-    int macro_end_column;
+    uint32_t begin_location;
+    uint32_t end_location;
+    uint32_t macro_begin_location;
+    uint32_t macro_end_location;
     const char *filename;
 };
 
 namespace dale
 {
+class DNodeArena;
+
 /*! Node
 
     The core syntactic element class.  Each node is either a token
@@ -106,8 +106,14 @@ public:
      */
     void copyTo(Node *other);
     /*! Construct a DNode from this node.
+     *  @param arena The arena from which to allocate the DNode (optional).
+     *
+     *  If an arena is provided, then the DNode and copies of its
+     *  token strings are allocated from the arena, and are only valid
+     *  for the lifetime of the arena.  Otherwise, they are allocated
+     *  by malloc.
      */
-    DNode *toDNode();
+    DNode *toDNode(DNodeArena *arena = NULL);
     /*! Set the current node's macro position from the argument node.
      *  @param mp_node The node from which to take the macro position.
      *
@@ -123,6 +129,24 @@ public:
 };
 
 Node *nullNode();
+/*! Delete a group of node trees.
+ *  @param roots The root nodes of the trees.
+ *
+ *  Unlike the Node destructor, this tolerates trees that share
+ *  nodes with one another, as happens when macro expansion results
+ *  are spliced back into the form containing the macro call.  Each
+ *  reachable node is deleted exactly once.  Null elements are
+ *  ignored.
+ */
+void deleteNodeTrees(std::vector<Node *> *roots);
+/*! Append an encoding of a node's structure to a key.
+ *  @param node The node.
+ *  @param key The key to which the encoding is appended.
+ *
+ *  Token strings are length-prefixed, so that distinct nodes cannot
+ *  produce the same key.  Positions are not included.
+ */
+void appendNodeKey(Node *node, std::string *key);
 }
 
 #endif
@@ -75,6 +75,17 @@ OffsetofGetByIndex(Unit *unit,
 {
     Context *ctx = unit->ctx;
 
+    /* As with SizeofGet, the offset is taken from the data layout
+     * where possible. */
+    llvm::Type *llvm_type = ctx->toLLVMType(type, NULL, false);
+    if (llvm_type && llvm_type->isStructTy() && llvm_type->isSized()) {
+        const llvm::StructLayout *sl =
+            unit->ee->getDataLayout()->getStructLayout(
+                llvm::cast<llvm::StructType>(llvm_type)
+            );
+        return sl->getElementOffset(index);
+    }
+
     llvm::Type *llvm_return_type =
         ctx->toLLVMType(ctx->tr->type_size, NULL, false);
     if (!llvm_return_type) {
@@ -33,6 +33,14 @@ SizeofGet(Unit *unit,
 {
     Context *ctx = unit->ctx;
 
+    /* If the type has a known layout, then its size can be taken
+     * from the execution engine's data layout, which avoids
+     * compiling and running a function that returns it. */
+    llvm::Type *llvm_type = ctx->toLLVMType(type, NULL, false);
+    if (llvm_type && llvm_type->isSized()) {
+        return unit->ee->getDataLayout()->getTypeAllocSize(llvm_type);
+    }
+
     llvm::Type *llvm_return_type =
         ctx->toLLVMType(ctx->tr->type_size, NULL, false);
     if (!llvm_return_type) {
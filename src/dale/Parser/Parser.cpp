@@ -24,24 +24,19 @@ Parser::getLexer()
 }
 
 void
-Parser::deleteNodeList(std::vector<Node *> *list)
+Parser::deleteNode(Node *node)
 {
     erep->flush();
 
-    for (std::vector<Node *>::iterator b = list->begin(),
-                                       e = list->end();
-            b != e; ++b) {
-        delete (*b);
-    }
-
-    delete list;
+    std::vector<Node *> roots;
+    roots.push_back(node);
+    deleteNodeTrees(&roots);
 }
 
 Node *
 Parser::getNextList()
 {
     Token ts(TokenType::Null);
-    Token te(TokenType::Null);
     Node n;
     n.filename = filename;
     Error e(ErrorInst::Null, &n);
@@ -58,117 +53,80 @@ Parser::getNextList()
     }
 
     if (ts.type != TokenType::LeftParen) {
-        e.begin = new Position(ts.begin);
-        e.end   = new Position(ts.end);
+        ts.begin.copyTo(&(e.begin));
+        ts.end.copyTo(&(e.end));
         e.instance = ErrorInst::ExpectedLeftParen;
         erep->addError(e);
         return NULL;
     }
 
-    int res;
-    std::vector<Node*> *list = new std::vector<Node*>;
-    while ((res = getNextListInternal(list)) == 1) {
-    }
-
-    if (res == 0) {
-        deleteNodeList(list);
-        return NULL;
-    }
-
-    lexer->getNextToken(&te, &e);
-
-    if (e.instance != ErrorInst::Null) {
-        erep->addError(e);
-        deleteNodeList(list);
-        return NULL;
-    }
+    Node *node = new Node(new std::vector<Node*>);
+    node->filename = filename;
+    ts.begin.copyTo(node->getBeginPos());
 
-    if (te.type != TokenType::RightParen) {
-        e.begin = new Position(te.begin);
-        e.end   = new Position(te.end);
-        e.instance = ErrorInst::MissingRightParen;
-        erep->addError(e);
-        deleteNodeList(list);
+    if (!getNextListInternal(node)) {
+        deleteNode(node);
         return NULL;
     }
 
-    Node *node = new Node(list);
-    node->filename = filename;
-    ts.begin.copyTo(node->getBeginPos());
-    te.begin.copyTo(node->getEndPos());
-
     return node;
 }
 
-int
-Parser::getNextListInternal(std::vector<Node*> *list)
+bool
+Parser::getNextListInternal(Node *top)
 {
     Token t(TokenType::Null);
     Node n;
     n.filename = filename;
     Error e(ErrorInst::Null, &n);
 
-    do {
-        lexer->getNextToken(&t, &e);
-        if (e.instance == ErrorInst::Null) {
-            break;
-        } else {
+    std::vector<Node *> open_lists;
+    open_lists.push_back(top);
+
+    while (!open_lists.empty()) {
+        do {
+            lexer->getNextToken(&t, &e);
+            if (e.instance == ErrorInst::Null) {
+                break;
+            } else {
+                erep->addError(e);
+                e.instance = ErrorInst::Null;
+            }
+        } while (1);
+
+        if (t.type == TokenType::Eof) {
+            t.end.copyTo(&(e.begin));
+            t.end.copyTo(&(e.end));
+            e.instance = ErrorInst::MissingRightParen;
             erep->addError(e);
-            e.instance = ErrorInst::Null;
-        }
-    } while (1);
-
-    if (t.type == TokenType::Eof) {
-        return 2;
-    }
-
-    if (t.type == TokenType::LeftParen) {
-        std::vector<Node*> *sublist = new std::vector<Node*>();
-        Node *node = new Node(sublist);
-        list->push_back(node);
-        node->filename = filename;
-        t.begin.copyTo(node->getBeginPos());
-        t.end.copyTo(node->getEndPos());
-
-        int res;
-        while ((res = (getNextListInternal(sublist))) == 1) {
-        }
-
-        if (res == 0) {
-            return 0;
+            return false;
         }
 
-        lexer->getNextToken(&t, &e);
+        Node *current = open_lists.back();
 
-        if (e.instance != ErrorInst::Null) {
-            erep->addError(e);
-            return 0;
+        if (t.type == TokenType::RightParen) {
+            t.begin.copyTo(current->getEndPos());
+            open_lists.pop_back();
+            continue;
         }
 
-        if (t.type != TokenType::RightParen) {
-            e.begin = new Position(t.begin);
-            e.end   = new Position(t.end);
-            e.instance = ErrorInst::MissingRightParen;
-            erep->addError(e);
-            return 0;
+        if (t.type == TokenType::LeftParen) {
+            Node *node = new Node(new std::vector<Node*>);
+            node->filename = filename;
+            t.begin.copyTo(node->getBeginPos());
+            t.end.copyTo(node->getEndPos());
+            current->list->push_back(node);
+            open_lists.push_back(node);
+            continue;
         }
-        t.begin.copyTo(node->getEndPos());
-
-        return 1;
-    }
 
-    if (t.type == TokenType::RightParen) {
-        lexer->ungetToken(&t);
-        return 2;
+        Token *tok_ptr = new Token(TokenType::Null);
+        t.copyTo(tok_ptr);
+        Node *node = new Node(tok_ptr);
+        node->filename = filename;
+        current->list->push_back(node);
     }
 
-    Token *tok_ptr = new Token(TokenType::Null);
-    t.copyTo(tok_ptr);
-    Node *node = new Node(tok_ptr);
-    node->filename = filename;
-
-    list->push_back(node);
-
-    return 1;
+    return true;
 }
 }
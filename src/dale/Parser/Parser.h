@@ -24,22 +24,23 @@ private:
     /*! The filename of the file being parsed. */
     const char *filename;
 
-    /*! Populate the list with nodes.
-     *  @param list The node list buffer.
+    /*! Populate a list node with its elements.
+     *  @param top The list node.
      *
-     *  This does not take ownership of the list.  Ownership of nodes
-     *  added to the list is passed to the caller.  A return value of
-     *  1 indicates that parsing may continue, a return value of 0
-     *  indicates that an error occurred, and a return value of 2
-     *  indicates EOF.
+     *  The opening parenthesis of the list must already have been
+     *  consumed.  Parsing is iterative, so the nesting depth of the
+     *  list is limited only by available memory.  Nodes are added to
+     *  the list as they are parsed, so on failure, top must still be
+     *  deleted by the caller.  Returns a boolean indicating whether
+     *  the list was parsed successfully.
      */
-    int getNextListInternal(std::vector<Node*> *list);
-    /*! Delete the node list.
-     *  @param list The node list.
+    bool getNextListInternal(Node *top);
+    /*! Delete a node.
+     *  @param node The node.
      *
-     *  Deletes each individual node, as well as the node list.
+     *  Flushes the error reporter before deleting the node.
      */
-    void deleteNodeList(std::vector<Node *> *list);
+    void deleteNode(Node *node);
 
 public:
     /*! Construct a new parser.
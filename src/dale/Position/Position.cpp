@@ -1,11 +1,63 @@
 #include "Position.h"
+#include "../FileTable/FileTable.h"
 
 namespace dale
 {
+static const uint32_t PACKED_FLAG   = 0x80000000;
+static const int      COLUMN_BITS   = 12;
+static const uint32_t COLUMN_MASK   = 0xFFF;
+static const uint32_t LINE_MASK     = 0x7FFFF;
+
+/* The FileTable sequence used for positions whose line or column
+ * number is too large to be packed. */
+static int unpackable_sequence = -1;
+
+static bool
+canPack(int line_number, int column_number)
+{
+    return ((line_number <= (int) LINE_MASK)
+            && (column_number <= (int) COLUMN_MASK));
+}
+
+static uint32_t
+packLocation(int line_number, int column_number)
+{
+    if (!line_number && !column_number) {
+        return 0;
+    }
+    uint32_t line   = (line_number > (int) LINE_MASK)
+                        ? LINE_MASK
+                        : (line_number < 0 ? 0 : line_number);
+    uint32_t column = (column_number > (int) COLUMN_MASK)
+                        ? COLUMN_MASK
+                        : (column_number < 0 ? 0 : column_number);
+    return (PACKED_FLAG | (line << COLUMN_BITS) | column);
+}
+
+static uint32_t
+makeLocation(int line_number, int column_number)
+{
+    if (!canPack(line_number, column_number)) {
+        /* Long generated lines commonly exceed the packed column
+         * range, so such positions are added to the file table
+         * instead.  The numbers are only truncated if the table is
+         * full. */
+        if (unpackable_sequence == -1) {
+            unpackable_sequence = FileTable::addSequence();
+        }
+        uint32_t location =
+            FileTable::getLocation(unpackable_sequence, line_number,
+                                   column_number);
+        if (location) {
+            return location;
+        }
+    }
+    return packLocation(line_number, column_number);
+}
+
 Position::Position()
 {
-    line_number = 0;
-    column_number = 0;
+    location = 0;
 }
 
 Position::Position(int line_number, int column_number)
@@ -15,40 +67,91 @@ Position::Position(int line_number, int column_number)
 
 Position::Position(Position *other)
 {
-    line_number   = other->line_number;
-    column_number = other->column_number;
+    location = other->location;
 }
 
 void
 Position::setLineAndColumn(int line_number, int column_number)
 {
-    this->line_number   = line_number;
-    this->column_number = column_number;
+    location = makeLocation(line_number, column_number);
+}
+
+void
+Position::getLineAndColumn(int *line_number, int *column_number)
+{
+    if (!location) {
+        *line_number   = 0;
+        *column_number = 0;
+    } else if (location & PACKED_FLAG) {
+        *line_number   = (location >> COLUMN_BITS) & LINE_MASK;
+        *column_number = location & COLUMN_MASK;
+    } else if (!FileTable::getLineAndColumn(location, line_number,
+                                            column_number)) {
+        *line_number   = 0;
+        *column_number = 0;
+    }
 }
 
 int
 Position::getLineNumber()
 {
+    int line_number;
+    int column_number;
+    getLineAndColumn(&line_number, &column_number);
     return line_number;
 }
 
 int
 Position::getColumnNumber()
 {
+    int line_number;
+    int column_number;
+    getLineAndColumn(&line_number, &column_number);
     return column_number;
 }
 
 void
 Position::copyTo(Position *other)
 {
-    other->line_number   = line_number;
-    other->column_number = column_number;
+    other->location = location;
 }
 
 void
 Position::zero()
 {
-    line_number   = 0;
-    column_number = 0;
+    location = 0;
+}
+
+bool
+Position::isSet()
+{
+    return (location != 0);
+}
+
+uint32_t
+Position::getLocation()
+{
+    return location;
+}
+
+void
+Position::setLocation(uint32_t location)
+{
+    this->location = location;
+}
+
+uint32_t
+Position::getPackedLocation()
+{
+    if (!location || (location & PACKED_FLAG)) {
+        return location;
+    }
+    int line_number;
+    int column_number;
+    getLineAndColumn(&line_number, &column_number);
+    if (!canPack(line_number, column_number)) {
+        return location;
+    }
+    return packLocation(line_number, column_number);
 }
 }
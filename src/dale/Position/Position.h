@@ -1,19 +1,26 @@
 #ifndef DALE_POSITION
 #define DALE_POSITION
 
+#include <stdint.h>
+
 namespace dale
 {
 /*! Position
 
     Represents a position in the code (line and column numbers).
+
+    The position is stored as a single 32-bit location.  If the
+    highest bit of the location is set, then the line and column
+    numbers are packed into the remaining bits.  Otherwise, the
+    location is a FileTable location, from which the line and column
+    numbers are computed only when they are needed.  A location of
+    zero means that the position has not been set.
 */
 class Position
 {
 private:
-    /*! The line number. */
-    int line_number;
-    /*! The column number. */
-    int column_number;
+    /*! The encoded location. */
+    uint32_t location;
 
 public:
     Position();
@@ -32,6 +39,11 @@ public:
     /*! Get the column number of the position.
      */
     int getColumnNumber();
+    /*! Get the line and column numbers of the position.
+     *  @param line_number Storage for the line number.
+     *  @param column_number Storage for the column number.
+     */
+    void getLineAndColumn(int *line_number, int *column_number);
     /*! Copy the details of this position to another.
      *  @param other The other position.
      */
@@ -39,11 +51,35 @@ public:
     /*! Set the line and column numbers for this position.
      *  @param line_number The line number.
      *  @param column_number The column number.
+     *
+     *  The numbers are packed into the location if they fit (see
+     *  getPackedLocation).  Otherwise, a FileTable location is used.
      */
     void setLineAndColumn(int line_number, int column_number);
     /*! Set the line and column numbers for this position to zero.
      */
     void zero();
+    /*! Check whether this position has been set.
+     */
+    bool isSet();
+    /*! Get the encoded location for this position.
+     */
+    uint32_t getLocation();
+    /*! Set the encoded location for this position.
+     *  @param location The location.
+     */
+    void setLocation(uint32_t location);
+    /*! Get the packed location for this position.
+     *
+     *  Unlike a FileTable location, a packed location remains valid
+     *  after the current compilation, so this should be used when
+     *  the position is to be stored in generated code.  Line numbers
+     *  must fit in 19 bits and column numbers in 12 bits.  If they do
+     *  not, then the FileTable location is returned unchanged, so
+     *  that the position is still correct for the current
+     *  compilation, rather than being truncated.
+     */
+    uint32_t getPackedLocation();
 };
 }
 
@@ -2,6 +2,7 @@
 
 #include "../llvm_LinkAll.h"
 #include "../NativeTypes/NativeTypes.h"
+#include "../UndoLog/UndoLog.h"
 
 namespace dale
 {
@@ -10,10 +11,10 @@ SavePoint::SavePoint(Context *ctx, Function *fn, llvm::BasicBlock *block)
     block_count = fn->llvm_function->size();
     instruction_index = block->size();
     dg_count = fn->deferred_gotos.size();
-    labels = fn->labels;
     this->block = block;
     this->fn = fn;
     csp = new ContextSavePoint(ctx);
+    log_index = UndoLog::getChanges()->size();
 }
 
 SavePoint::~SavePoint()
@@ -28,33 +29,33 @@ SavePoint::restore()
 {
     int block_pop_back = fn->llvm_function->size() - block_count;
     while (block_pop_back--) {
-        llvm::Function::iterator bi = fn->llvm_function->begin(),
-                                 be = fn->llvm_function->end(),
-                                 bl;
-        while (bi != be) {
-            bl = bi;
-            ++bi;
-        }
-        bl->eraseFromParent();
+        fn->llvm_function->back().eraseFromParent();
     }
 
     int to_pop_back = block->size() - instruction_index;
     while (to_pop_back--) {
-        llvm::BasicBlock::iterator bi = block->begin(),
-                                   be = block->end(),
-                                   bl;
-        while (bi != be) {
-            bl = bi;
-            ++bi;
-        }
-        bl->eraseFromParent();
+        block->back().eraseFromParent();
     }
 
     int dg_to_pop_back = fn->deferred_gotos.size() - dg_count;
     while (dg_to_pop_back--) {
         fn->deferred_gotos.pop_back();
     }
-    fn->labels = labels;
+
+    /* Remove the labels that were added to this function.  Labels
+     * added to other functions are left for the context save point
+     * to keep. */
+    std::vector<UndoLog::Change> *changes = UndoLog::getChanges();
+    for (std::vector<UndoLog::Change>::iterator
+            b = changes->begin() + log_index,
+            e = changes->end();
+            b != e;
+            ++b) {
+        if ((b->type == UndoLog::LabelAdded) && (b->fn == fn)) {
+            fn->labels.erase(b->name);
+            b->type = UndoLog::Removed;
+        }
+    }
 
     csp->restore();
     delete csp;
@@ -2,13 +2,8 @@
 #define DALE_SAVEPOINT
 
 #include "../Context/Context.h"
-#include "../NamespaceSavePoint/NamespaceSavePoint.h"
 #include "../ContextSavePoint/ContextSavePoint.h"
 
-#include <vector>
-#include <string>
-#include <map>
-
 namespace dale
 {
 /*! SavePoint
@@ -23,7 +18,7 @@ private:
     int block_count;
     int instruction_index;
     int dg_count;
-    std::map<std::string, Label*> labels;
+    int log_index;
     Function *fn;
     llvm::BasicBlock *block;
     ContextSavePoint *csp;
@@ -118,12 +118,7 @@ char *deserialise(TypeRegister *tr, char *in, std::string *x)
 {
     size_t s;
     in = deserialise(tr, in, &s);
-    x->reserve(s);
-    char buf[256];
-    strncpy(buf, in, s);
-    buf[s] = '\0';
-    x->clear();
-    x->append(buf);
+    x->assign(in, s);
     return in + s;
 }
 
@@ -316,6 +311,7 @@ void serialise(FILE *out, Function *fn)
     serialise(out, fn->always_inline);
     serialise(out, fn->once_tag);
     serialise(out, fn->cto);
+    serialise(out, fn->is_pure);
     serialise(out, fn->linkage);
 
     return;
@@ -339,6 +335,7 @@ char *deserialise(TypeRegister *tr, char *in, Function *fn)
     in = deserialise(tr, in, &(fn->always_inline));
     in = deserialise(tr, in, &(fn->once_tag));
     in = deserialise(tr, in, &(fn->cto));
+    in = deserialise(tr, in, &(fn->is_pure));
     in = deserialise(tr, in, &(fn->linkage));
 
     return in;
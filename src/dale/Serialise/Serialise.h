@@ -9,6 +9,7 @@
 #include "../Context/Context.h"
 #include "../Namespace/Namespace.h"
 #include "../TypeRegister/TypeRegister.h"
+#include "../HashMap/HashMap.h"
 
 namespace dale
 {
@@ -44,6 +45,12 @@ void serialise(FILE *out, std::map<T1, T2> *x);
 template<typename T1, typename T2>
 char *deserialise(TypeRegister *tr, char *in, std::map<T1, T2> *x);
 
+template<typename T>
+void serialise(FILE *out, HashMap<T> *x);
+
+template<typename T>
+char *deserialise(TypeRegister *tr, char *in, HashMap<T> *x);
+
 void xfwrite(const void *a, size_t b, size_t c, FILE *d);
 
 void serialise(FILE *out, bool a);
@@ -248,6 +255,34 @@ char *deserialise(TypeRegister *tr, char *in, std::map<T1, T2> *x)
     }
     return in;
 }
+
+template<typename T>
+void serialise(FILE *out, HashMap<T> *x)
+{
+    size_t s = x->size();
+    serialise(out, s);
+    for (typename HashMap<T>::iterator b = x->begin(), e = x->end();
+            b != e;
+            ++b) {
+        serialise(out, b->first);
+        serialise(out, b->second);
+    }
+}
+
+template<typename T>
+char *deserialise(TypeRegister *tr, char *in, HashMap<T> *x)
+{
+    size_t s;
+    in = deserialise(tr, in, &s);
+    for (size_t i = 0; i < s; i++) {
+        std::string key;
+        in = deserialise(tr, in, &key);
+        T value;
+        in = deserialise(tr, in, &value);
+        x->insert(std::pair<std::string, T>(key, value));
+    }
+    return in;
+}
 }
 
 #endif
@@ -48,7 +48,7 @@ Struct::indexToType(int index)
 int
 Struct::nameToIndex(const char *name)
 {
-    std::map<std::string, int>::iterator iter =
+    HashMap<int>::iterator iter =
         name_to_index.find(name);
 
     if (iter == name_to_index.end()) {
@@ -61,7 +61,7 @@ Struct::nameToIndex(const char *name)
 const char *
 Struct::indexToName(int index)
 {
-    std::map<std::string, int>::iterator iter;
+    HashMap<int>::iterator iter;
 
     iter = name_to_index.begin();
     while (iter != name_to_index.end()) {
@@ -4,6 +4,7 @@
 #include "../Type/Type.h"
 #include "../Linkage/Linkage.h"
 #include "../llvm_Module.h"
+#include "../HashMap/HashMap.h"
 
 #include <string>
 #include <vector>
@@ -26,7 +27,7 @@ public:
     /* The types of the struct's members. */
     std::vector<Type *> member_types;
     /* A map from member name to index. */
-    std::map<std::string, int> name_to_index;
+    HashMap<int> name_to_index;
     /* The struct's once tag. */
     std::string once_tag;
     /* The struct's linkage. */
@@ -47,12 +47,36 @@ Type::reset()
     is_const        = false;
     is_reference    = false;
     is_retval       = false;
+
+    is_registered   = false;
+    display_string.clear();
+    display_string_flags        = 0;
+    display_string_typemap_size = 0;
+    symbol_string.clear();
+}
+
+int
+Type::getQualifierFlags()
+{
+    return (is_const ? 1 : 0) | (is_reference ? 2 : 0) | (is_retval ? 4 : 0);
 }
 
 bool
 Type::isEqualTo(Type *other_type,
                 bool ignore_arg_constness)
 {
+    if (this == other_type) {
+        return true;
+    }
+
+    /* There is only one registered instance of each type, so two
+     * different registered types can only be equal when argument
+     * constness is being ignored. */
+    if (is_registered && other_type->is_registered
+            && !ignore_arg_constness) {
+        return false;
+    }
+
     if (base_type != other_type->base_type) {
         return false;
     }
@@ -258,11 +282,38 @@ Type::toNode()
 }
 
 void Type::toString(std::string *str)
+{
+    /* The display string for a struct type depends on the type map,
+     * which only ever grows, so the cached string is valid for as
+     * long as the type map's size is unchanged.  Callers sometimes
+     * toggle a registered type's qualifiers temporarily, so those
+     * are checked as well. */
+    if (!is_registered) {
+        toStringUncached(str);
+        return;
+    }
+
+    int flags = getQualifierFlags();
+    if (display_string.size()
+            && (display_string_flags == flags)
+            && (display_string_typemap_size == dale_typemap.size())) {
+        str->append(display_string);
+        return;
+    }
+
+    display_string.clear();
+    toStringUncached(&display_string);
+    display_string_flags        = flags;
+    display_string_typemap_size = dale_typemap.size();
+    str->append(display_string);
+}
+
+void Type::toStringUncached(std::string *str)
 {
     if (is_const) {
         str->append("(const ");
         is_const = false;
-        toString(str);
+        toStringUncached(str);
         str->append(")");
         is_const = true;
         return;
@@ -271,7 +322,7 @@ void Type::toString(std::string *str)
     if (is_reference) {
         str->append("(ref ");
         is_reference = false;
-        toString(str);
+        toStringUncached(str);
         str->append(")");
         is_reference = true;
         return;
@@ -390,7 +441,42 @@ Type *Type::makeCopy()
     return new_type;
 }
 
+Type *Type::makeShallowCopy()
+{
+    Type *new_type = new Type();
+
+    new_type->base_type       = base_type;
+    new_type->is_array        = is_array;
+    new_type->array_size      = array_size;
+    new_type->array_type      = array_type;
+    new_type->bitfield_size   = bitfield_size;
+    new_type->is_const        = is_const;
+    new_type->is_reference    = is_reference;
+    new_type->is_retval       = is_retval;
+    new_type->struct_name     = struct_name;
+    new_type->namespaces      = namespaces;
+    new_type->points_to       = points_to;
+    new_type->is_function     = is_function;
+    new_type->return_type     = return_type;
+    new_type->parameter_types = parameter_types;
+
+    return new_type;
+}
+
 void Type::toSymbolString(std::string *to)
+{
+    if (!is_registered) {
+        toSymbolStringUncached(to);
+        return;
+    }
+
+    if (!symbol_string.size()) {
+        toSymbolStringUncached(&symbol_string);
+    }
+    to->append(symbol_string);
+}
+
+void Type::toSymbolStringUncached(std::string *to)
 {
     if (points_to) {
         to->append("P");
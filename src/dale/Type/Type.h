@@ -21,8 +21,8 @@ namespace dale
     be an abstract base class with subclasses for each 'type' of
     type.)
 
-    Putting aside function types, there should generally only be one
-    instance for a given type.  See TypeRegister.
+    There should generally only be one instance for a given type.
+    See TypeRegister.
 */
 class Type
 {
@@ -64,6 +64,11 @@ public:
     /*! For a function type, the parameter types. */
     std::vector<Type*> parameter_types;
 
+    /*! Whether the type is owned by a TypeRegister.  The display and
+     *  symbol strings of registered types are cached, since they are
+     *  not modified after construction. */
+    bool is_registered;
+
     Type();
     /*! Construct a new type with the given base type.
      *  @param base_type The new base type.
@@ -135,6 +140,12 @@ public:
      *  TypeRegister should be the only client for this method.
      */
     Type *makeCopy();
+    /*! Make a shallow copy of the type.  The copy refers to the same
+     *  component types as this type.
+     *
+     *  TypeRegister should be the only client for this method.
+     */
+    Type *makeShallowCopy();
 
     /*! Check whether this type is an integer type.
      */
@@ -161,6 +172,22 @@ public:
     /*! Get the number of arguments required by this function type.
      */
     int numberOfRequiredArgs();
+    /*! Get the qualifiers of this type as flags: 1 for const, 2 for
+     *  reference and 4 for retval.
+     */
+    int getQualifierFlags();
+
+private:
+    /*! The cached display string, the qualifier flags at the time it
+     *  was generated, and the size of the type map at that time. */
+    std::string display_string;
+    int display_string_flags;
+    size_t display_string_typemap_size;
+    /*! The cached symbol string. */
+    std::string symbol_string;
+
+    void toStringUncached(std::string *to);
+    void toSymbolStringUncached(std::string *to);
 };
 }
 
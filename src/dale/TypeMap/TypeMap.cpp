@@ -8,7 +8,7 @@
 
 namespace dale
 {
-std::map<std::string, std::string> dale_typemap;
+HashMap<std::string> dale_typemap;
 
 bool
 addTypeMapEntry(const char *from, const char *to)
@@ -20,7 +20,7 @@ addTypeMapEntry(const char *from, const char *to)
 bool
 getTypeMapEntry(const char *from, std::string *to)
 {
-    std::map<std::string, std::string>::iterator iter
+    HashMap<std::string>::iterator iter
         = dale_typemap.find(from);
     if (iter != dale_typemap.end()) {
         to->append(iter->second);
@@ -1,6 +1,8 @@
 #ifndef DALE_ELEMENT_TYPEMAP
 #define DALE_ELEMENT_TYPEMAP
 
+#include "../HashMap/HashMap.h"
+
 #include <string>
 #include <map>
 
@@ -17,7 +19,7 @@ namespace dale
 
 /*! A map from underlying type name to the string that should be used
  *  for type display. */
-extern std::map<std::string, std::string> dale_typemap;
+extern HashMap<std::string> dale_typemap;
 
 /*! Add a type map entry.
  *  @param from The underlying type name.
@@ -35,6 +35,10 @@ TypeRegister::TypeRegister()
     basic_types[BaseType::Int128]     = new Type(BaseType::Int128);
     basic_types[BaseType::UInt128]    = new Type(BaseType::UInt128);
 
+    for (int i = 1; i < BASIC_TYPE_COUNT; i++) {
+        registerType(basic_types[i]);
+    }
+
     type_bool        = getBasicType(BaseType::Bool);
     type_void        = getBasicType(BaseType::Void);
     type_varargs     = getBasicType(BaseType::VarArgs);
@@ -73,12 +77,18 @@ TypeRegister::~TypeRegister()
     }
 
     STL::deleteMapElements(&pointer_types);
-    STL::deleteMapElements(&const_types);
+    STL::deleteMapElements(&qualified_types);
     STL::deleteMapElements(&struct_types);
-    STL::deleteMapElements(&reference_types);
-    STL::deleteMapElements(&retval_types);
     STL::deleteNestedMapElements(&array_types);
     STL::deleteNestedMapElements(&bitfield_types);
+    STL::deleteMapElements(&function_types);
+}
+
+Type*
+TypeRegister::registerType(Type *type)
+{
+    type->is_registered = true;
+    return type;
 }
 
 Type*
@@ -96,7 +106,7 @@ TypeRegister::getPointerType(Type *type)
         return b->second;
     }
 
-    Type *pointer_type = new Type(type);
+    Type *pointer_type = registerType(new Type(type));
     pointer_types.insert(
         std::pair<Type*, Type*>(type, pointer_type)
     );
@@ -114,7 +124,7 @@ TypeRegister::getArrayType(Type *type, size_t size)
         if (ab != ae) {
             return ab->second;
         } else {
-            Type *array_type = new Type();
+            Type *array_type = registerType(new Type());
             array_type->is_array = 1;
             array_type->array_type = type;
             array_type->array_size = size;
@@ -136,6 +146,15 @@ TypeRegister::getArrayType(Type *type, size_t size)
 Type*
 TypeRegister::getBitfieldType(Type *type, size_t size)
 {
+    /* Qualifiers are applied after the bitfield size, so that there
+     * is one instance for each qualified bitfield type. */
+    std::map<Type*, Type*>::iterator
+        ub = unqualified_types.find(type), ue = unqualified_types.end();
+    if (ub != ue) {
+        return getQualifiedType(getBitfieldType(ub->second, size),
+                                type->getQualifierFlags());
+    }
+
     std::map<Type*, std::map<size_t, Type*> >::iterator
         b = bitfield_types.find(type), e = bitfield_types.end();
     if (b != e) {
@@ -144,7 +163,7 @@ TypeRegister::getBitfieldType(Type *type, size_t size)
         if (ab != ae) {
             return ab->second;
         } else {
-            Type *bitfield_type = type->makeCopy();
+            Type *bitfield_type = registerType(type->makeShallowCopy());
             bitfield_type->bitfield_size = size;
             b->second.insert(
                 std::pair<size_t, Type*>(size, bitfield_type)
@@ -162,54 +181,59 @@ TypeRegister::getBitfieldType(Type *type, size_t size)
 }
 
 Type*
-TypeRegister::getConstType(Type *type)
+TypeRegister::getQualifiedType(Type *type, int flags)
 {
     std::map<Type*, Type*>::iterator
-        b = const_types.find(type), e = const_types.end();
+        ub = unqualified_types.find(type), ue = unqualified_types.end();
+    if (ub != ue) {
+        type = ub->second;
+    }
+    if (flags == type->getQualifierFlags()) {
+        return type;
+    }
+
+    std::pair<Type*, int> key(type, flags);
+    std::map<std::pair<Type*, int>, Type*>::iterator
+        b = qualified_types.find(key), e = qualified_types.end();
     if (b != e) {
         return b->second;
     }
 
-    Type *const_type = type->makeCopy();
-    const_type->is_const = 1;
-    const_types.insert(
-        std::pair<Type*, Type*>(type, const_type)
+    Type *qualified_type = registerType(type->makeShallowCopy());
+    qualified_type->is_const     = (flags & 1);
+    qualified_type->is_reference = (flags & 2);
+    qualified_type->is_retval    = (flags & 4);
+    qualified_types.insert(
+        std::pair<std::pair<Type*, int>, Type*>(key, qualified_type)
+    );
+    unqualified_types.insert(
+        std::pair<Type*, Type*>(qualified_type, type)
     );
-    return const_type;
+    return qualified_type;
 }
 
 Type*
-TypeRegister::getReferenceType(Type *type)
+TypeRegister::getConstType(Type *type)
 {
-    std::map<Type*, Type*>::iterator
-        b = reference_types.find(type), e = reference_types.end();
-    if (b != e) {
-        return b->second;
-    }
+    return getQualifiedType(type, type->getQualifierFlags() | 1);
+}
 
-    Type *reference_type = type->makeCopy();
-    reference_type->is_reference = 1;
-    reference_types.insert(
-        std::pair<Type*, Type*>(type, reference_type)
-    );
-    return reference_type;
+Type*
+TypeRegister::getReferenceType(Type *type)
+{
+    return getQualifiedType(type, type->getQualifierFlags() | 2);
 }
 
 Type*
 TypeRegister::getRetvalType(Type *type)
 {
-    std::map<Type*, Type*>::iterator
-        b = retval_types.find(type), e = retval_types.end();
-    if (b != e) {
-        return b->second;
-    }
+    return getQualifiedType(type, type->getQualifierFlags() | 4);
+}
 
-    Type *retval_type = type->makeCopy();
-    retval_type->is_retval = 1;
-    retval_types.insert(
-        std::pair<Type*, Type*>(type, retval_type)
-    );
-    return retval_type;
+Type*
+TypeRegister::getNonConstType(Type *type)
+{
+    return getQualifiedType(type, type->getQualifierFlags() & ~1);
 }
 
 Type*
@@ -224,7 +248,7 @@ TypeRegister::getStructType(const char *name)
     std::vector<std::string> name_parts;
     std::string ss(name);
     splitString(&ss, &name_parts, '.');
-    Type *struct_type = new Type();
+    Type *struct_type = registerType(new Type());
     struct_type->struct_name = name_parts.back();
     name_parts.pop_back();
 
@@ -236,6 +260,30 @@ TypeRegister::getStructType(const char *name)
     return struct_type;
 }
 
+Type*
+TypeRegister::getFunctionType(Type *return_type,
+                              std::vector<Type*> *parameter_types)
+{
+    std::pair<Type*, std::vector<Type*> > key(return_type,
+                                              *parameter_types);
+    std::map<std::pair<Type*, std::vector<Type*> >, Type*>::iterator
+        b = function_types.find(key), e = function_types.end();
+    if (b != e) {
+        return b->second;
+    }
+
+    Type *function_type = registerType(new Type());
+    function_type->is_function = true;
+    function_type->return_type = return_type;
+    function_type->parameter_types = *parameter_types;
+    function_types.insert(
+        std::pair<std::pair<Type*, std::vector<Type*> >, Type*>(
+            key, function_type
+        )
+    );
+    return function_type;
+}
+
 Type*
 TypeRegister::getType(Type *type)
 {
@@ -249,6 +297,10 @@ TypeRegister::getType(Type *type)
         type->is_reference = 0;
         final = getReferenceType(getType(type));
         type->is_reference = 1;
+    } else if (type->is_retval) {
+        type->is_retval = 0;
+        final = getRetvalType(getType(type));
+        type->is_retval = 1;
     } else if (type->is_array) {
         final = getArrayType(getType(type->array_type), type->array_size);
     } else if (type->points_to) {
@@ -270,6 +322,17 @@ TypeRegister::getType(Type *type)
         type->bitfield_size = 0;
         final = getBitfieldType(getType(type), bitfield_size);
         type->bitfield_size = bitfield_size;
+    } else if (type->is_function) {
+        std::vector<Type*> parameter_types;
+        for (std::vector<Type*>::iterator
+                b = type->parameter_types.begin(),
+                e = type->parameter_types.end();
+                b != e;
+                ++b) {
+            parameter_types.push_back(getType(*b));
+        }
+        final = getFunctionType(getType(type->return_type),
+                                &parameter_types);
     } else if (type->base_type) {
         final = getBasicType(type->base_type);
     }
@@ -281,9 +344,10 @@ void
 TypeRegister::print()
 {
     fprintf(stderr, "Pointer type count: %lu\n", pointer_types.size());
-    fprintf(stderr, "Const type count:   %lu\n", const_types.size());
+    fprintf(stderr, "Qual. type count:   %lu\n", qualified_types.size());
     fprintf(stderr, "Array type count:   %lu\n", array_types.size());
     fprintf(stderr, "BF type count:      %lu\n", bitfield_types.size());
     fprintf(stderr, "Struct type count:  %lu\n", struct_types.size());
+    fprintf(stderr, "Fn type count:      %lu\n", function_types.size());
 }
 }
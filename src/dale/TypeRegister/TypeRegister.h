@@ -5,6 +5,7 @@
 #include "../Type/Type.h"
 
 #include <map>
+#include <vector>
 
 namespace dale
 {
@@ -22,18 +23,32 @@ private:
     Type *basic_types[BASIC_TYPE_COUNT];
     /*! A map from type to pointer type. */
     std::map<Type*, Type*> pointer_types;
-    /*! A map from type to const type. */
-    std::map<Type*, Type*> const_types;
-    /*! A map from type to reference type. */
-    std::map<Type*, Type*> reference_types;
-    /*! A map from type to retval type. */
-    std::map<Type*, Type*> retval_types;
+    /*! A map from unqualified type and qualifier flags (see
+     *  Type::getQualifierFlags) to qualified type. */
+    std::map<std::pair<Type*, int>, Type*> qualified_types;
+    /*! A map from qualified type to unqualified type. */
+    std::map<Type*, Type*> unqualified_types;
     /*! A map from type, to size, to array type. */
     std::map<Type*, std::map<size_t, Type*> > array_types;
     /*! A map from type, to size, to bitfield type. */
     std::map<Type*, std::map<size_t, Type*> > bitfield_types;
     /*! A map from fully-qualified struct name to struct type. */
     std::map<std::string, Type*> struct_types;
+    /*! A map from return type and parameter types to function type. */
+    std::map<std::pair<Type*, std::vector<Type*> >, Type*> function_types;
+
+    /*! Mark a new type as being owned by the register.
+     *  @param type The type. */
+    Type *registerType(Type *type);
+    /*! Return an instance of a type with the given qualifiers.
+     *  @param type The type.
+     *  @param flags The qualifier flags (see Type::getQualifierFlags).
+     *
+     *  The qualified type shares its component types with the
+     *  unqualified type, and there is one instance for each set of
+     *  qualifiers, regardless of the order in which they were
+     *  added. */
+    Type *getQualifiedType(Type *type, int flags);
 
 public:
     /*! The standard constructor. Initialises the basic types. */
@@ -55,6 +70,9 @@ public:
     /*! Return an instance of a retval type.
      *  @param type The type to make into a retval type. */
     Type *getRetvalType(Type *type);
+    /*! Return an instance of a type without the const qualifier.
+     *  @param type The type to make non-const. */
+    Type *getNonConstType(Type *type);
     /*! Return an instance of an array type.
      *  @param type The array element type.
      *  @param size The size of the array. */
@@ -66,6 +84,11 @@ public:
     /*! Return an instance of a struct type.
      *  @param name The fully-qualified name of the struct. */
     Type *getStructType(const char *name);
+    /*! Return an instance of a function type.
+     *  @param return_type The return type.
+     *  @param parameter_types The parameter types. */
+    Type *getFunctionType(Type *return_type,
+                          std::vector<Type*> *parameter_types);
 
     /*! Takes a type, and returns a previously-generated type object,
      *  if possible. Otherwise, stores the type in the appropriate
@@ -0,0 +1,121 @@
+#include "UndoLog.h"
+
+#include "../Context/Context.h"
+
+namespace dale
+{
+namespace UndoLog
+{
+static std::vector<Change> changes;
+static int save_point_count = 0;
+
+int
+begin()
+{
+    ++save_point_count;
+    return changes.size();
+}
+
+void
+end()
+{
+    if (--save_point_count == 0) {
+        changes.clear();
+    }
+}
+
+bool
+isRecording()
+{
+    return (save_point_count > 0);
+}
+
+std::vector<Change> *
+getChanges()
+{
+    return &changes;
+}
+
+static void
+initChange(Change *change, int type, Namespace *ns)
+{
+    change->type          = type;
+    change->ns            = ns;
+    change->fn_list       = NULL;
+    change->fn_list_size  = 0;
+    change->parent_nsnode = NULL;
+    change->nsnode        = NULL;
+    change->child_ns      = NULL;
+    change->fn            = NULL;
+}
+
+void
+addFunctionChange(Namespace *ns, const char *name,
+                  std::vector<Function *> *fn_list,
+                  int previous_size)
+{
+    if (!isRecording()) {
+        return;
+    }
+    Change change;
+    initChange(&change, FunctionAdded, ns);
+    change.fn_list      = fn_list;
+    change.fn_list_size = previous_size;
+    change.name         = name;
+    changes.push_back(change);
+}
+
+void
+addBindingChange(int type, Namespace *ns)
+{
+    if (!isRecording()) {
+        return;
+    }
+    Change change;
+    initChange(&change, type, ns);
+    changes.push_back(change);
+}
+
+void
+addNamespaceChange(NSNode *parent_nsnode, NSNode *nsnode,
+                   const char *name)
+{
+    if (!isRecording()) {
+        return;
+    }
+    Change change;
+    initChange(&change, NamespaceAdded, parent_nsnode->ns);
+    change.parent_nsnode = parent_nsnode;
+    change.nsnode        = nsnode;
+    change.child_ns      = nsnode->ns;
+    change.name          = name;
+    changes.push_back(change);
+}
+
+void
+addLabelChange(Function *fn, const char *name)
+{
+    if (!isRecording()) {
+        return;
+    }
+    Change change;
+    initChange(&change, LabelAdded, NULL);
+    change.fn   = fn;
+    change.name = name;
+    changes.push_back(change);
+}
+
+void
+removeNamespace(Namespace *ns)
+{
+    for (std::vector<Change>::iterator b = changes.begin(),
+                                       e = changes.end();
+            b != e;
+            ++b) {
+        if ((b->ns == ns) || (b->child_ns == ns)) {
+            b->type = Removed;
+        }
+    }
+}
+}
+}
@@ -0,0 +1,112 @@
+#ifndef DALE_UNDOLOG
+#define DALE_UNDOLOG
+
+#include <string>
+#include <vector>
+
+namespace dale
+{
+class Function;
+class Namespace;
+struct NSNode;
+
+/*! UndoLog
+
+    Records changes to namespaces, to the namespace tree and to
+    function labels while at least one save point exists, so that a
+    save point can undo those changes without first having to copy
+    everything that they might affect.  A save point is the length of
+    the log at the time that it was created.
+*/
+namespace UndoLog
+{
+/*! The types of change that are recorded. */
+enum
+{
+    Removed,
+    FunctionAdded,
+    VariableAdded,
+    StructAdded,
+    EnumAdded,
+    NamespaceAdded,
+    LabelAdded
+};
+
+/*! A single change. */
+struct Change
+{
+    int type;
+    /*! The namespace that was changed.  For NamespaceAdded, this is
+     *  the parent namespace. */
+    Namespace *ns;
+    /*! For FunctionAdded, the overload list that was changed, and its
+     *  size before the change (-1 if the list is new). */
+    std::vector<Function *> *fn_list;
+    int fn_list_size;
+    /*! For NamespaceAdded, the parent node, the new node, and the new
+     *  node's namespace. */
+    NSNode *parent_nsnode;
+    NSNode *nsnode;
+    Namespace *child_ns;
+    /*! For LabelAdded, the function to which the label was added. */
+    Function *fn;
+    /*! For FunctionAdded, NamespaceAdded and LabelAdded, the name of
+     *  the new binding. */
+    std::string name;
+};
+
+/*! Begin recording changes for a new save point.
+ *
+ *  Returns the current length of the log.
+ */
+int begin();
+/*! Stop recording changes for the most recent save point.  Once
+ *  there are no save points left, the log is cleared.
+ */
+void end();
+/*! Check whether changes are currently being recorded.
+ */
+bool isRecording();
+/*! Get the recorded changes.
+ */
+std::vector<Change> *getChanges();
+
+/*! Record the addition of a function to an overload list.
+ *  @param ns The namespace.
+ *  @param name The function name.
+ *  @param fn_list The overload list.
+ *  @param previous_size The size of the list before the function was
+ *                       added, or -1 if the list is new.
+ */
+void addFunctionChange(Namespace *ns, const char *name,
+                       std::vector<Function *> *fn_list,
+                       int previous_size);
+/*! Record the addition of a variable, struct or enum.
+ *  @param type The type of change.
+ *  @param ns The namespace.
+ */
+void addBindingChange(int type, Namespace *ns);
+/*! Record the addition of a namespace to the namespace tree.
+ *  @param parent_nsnode The parent node.
+ *  @param nsnode The new node.
+ *  @param name The name of the new namespace.
+ */
+void addNamespaceChange(NSNode *parent_nsnode, NSNode *nsnode,
+                        const char *name);
+/*! Record the addition of a label to a function.
+ *  @param fn The function.
+ *  @param name The name of the label.
+ */
+void addLabelChange(Function *fn, const char *name);
+/*! Remove all changes that refer to a namespace.
+ *  @param ns The namespace.
+ *
+ *  This must be called when a namespace is deleted.  The changes are
+ *  marked as removed, rather than being erased, so that the log
+ *  lengths held by save points remain valid.
+ */
+void removeNamespace(Namespace *ns);
+}
+}
+
+#endif
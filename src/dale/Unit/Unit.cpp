@@ -14,9 +14,9 @@ Unit::Unit(const char *path, Units *units, ErrorReporter *er, NativeTypes *nt,
 {
     FILE *mfp = fopen(path, "r");
     if (!mfp) {
-        char buf[1024];
-        sprintf(buf, "unable to open %s for reading", path);
-        error(buf, true);
+        std::string msg("unable to open ");
+        msg.append(path).append(" for reading");
+        error(msg.c_str(), true);
     }
 
     er->current_filename = path;
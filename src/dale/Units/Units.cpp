@@ -71,4 +71,14 @@ Units::push(Unit *new_unit)
 
     return;
 }
+
+void
+Units::releaseNodes(Node *top)
+{
+    if (top) {
+        expansion_nodes.push_back(top);
+    }
+    deleteNodeTrees(&expansion_nodes);
+    expansion_nodes.clear();
+}
 }
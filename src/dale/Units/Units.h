@@ -4,6 +4,7 @@
 #include "../Unit/Unit.h"
 #include "../Module/Reader/Reader.h"
 #include "../Namespace/Namespace.h"
+#include "../HashMap/HashMap.h"
 #include <stack>
 
 namespace dale
@@ -37,6 +38,26 @@ public:
     /*! Whether the standard library (libdrt) should be imported into
      *  each new unit. */
     bool no_dale_stdlib;
+    /*! The root nodes of the macro expansions produced while
+     *  processing the current top-level form.  These are released by
+     *  releaseNodes. */
+    std::vector<Node *> expansion_nodes;
+    /*! Cached results of has-errors probes, keyed by the probe's
+     *  form.  These are only valid for probe_scope, and are discarded
+     *  when the scope changes (see Introspection). */
+    HashMap<bool> probe_results;
+    /*! The scope for which probe_results are valid. */
+    std::string probe_scope;
+    /*! Cached results of exists-fn probes, keyed by the function
+     *  name and the parameter types.  Each result is stored with the
+     *  overload generation of the name when the result was cached
+     *  (see BindingChanges::getGeneration), and is only used while
+     *  that generation is current.  These are only valid for
+     *  fn_probe_scope. */
+    std::map<std::pair<std::string, std::vector<Type *> >,
+             std::pair<int, bool> > fn_probe_results;
+    /*! The scope for which fn_probe_results are valid. */
+    std::string fn_probe_scope;
 
     /*! Construct a new Units object.
      *  @param mr A module reader.
@@ -62,6 +83,16 @@ public:
      *  topmost unit is merged into the new unit's context.
      */
     void push(Unit *new_unit);
+    /*! Release a processed top-level form.
+     *  @param top The top-level form node.
+     *
+     *  Deletes the form, as well as each macro expansion produced
+     *  while it was being processed.  Once a top-level form has been
+     *  processed, none of its nodes are referenced again, so this
+     *  keeps memory use bounded by the largest single form rather
+     *  than by the size of the file.
+     */
+    void releaseNodes(Node *top);
 };
 }
 
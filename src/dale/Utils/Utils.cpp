@@ -256,12 +256,12 @@ getNullPointer(llvm::Type *type)
 void
 error(const char *error_msg, bool show_perror)
 {
-    char buf[1024];
-    sprintf(buf, "%s: %s", progname, error_msg);
+    std::string msg;
+    msg.append(progname).append(": ").append(error_msg);
     if (show_perror) {
-        perror(buf);
+        perror(msg.c_str());
     } else {
-        fprintf(stderr, "%s\n", buf);
+        fprintf(stderr, "%s\n", msg.c_str());
     }
     exit(1);
 }
@@ -2,10 +2,12 @@
 
 #include "Config.h"
 #include "Utils/Utils.h"
+#include "MacroProfile/MacroProfile.h"
 #include <cstring>
 #include <cstdlib>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <sys/resource.h>
 #include <getopt.h>
 #include <cstdio>
 
@@ -54,9 +56,9 @@ copyFile(const char *to_path, FILE *from)
 {
     FILE *to = fopen(to_path, "w");
     if (!to) {
-        char buf[1024];
-        sprintf(buf, "unable to open %s for writing", to_path);
-        error(buf, true);
+        std::string msg("unable to open ");
+        msg.append(to_path).append(" for writing");
+        error(msg.c_str(), true);
     }
     char buf[COPY_SIZE];
     memset(buf, 0, COPY_SIZE);
@@ -106,6 +108,22 @@ copyFile(const char *to_path, FILE *from)
     return success;
 }
 
+static void
+printMaxMemory()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage)) {
+        error("unable to get resource usage", true);
+    }
+    /* ru_maxrss is in bytes on OS X, and in kilobytes elsewhere. */
+    long max_rss = usage.ru_maxrss;
+    if (!strcmp(SYSTEM_NAME, "Darwin")) {
+        max_rss /= 1024;
+    }
+    fprintf(stderr, "%s: maximum memory usage: %ld KB\n",
+            progname, max_rss);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -146,6 +164,8 @@ main(int argc, char **argv)
     int found_ctom      = 0;
     int enable_cto      = 0;
     int version         = 0;
+    int max_memory      = 0;
+    int macro_profile   = 0;
 
     int option_index         = 0;
     int forced_remove_macros = 0;
@@ -159,6 +179,8 @@ main(int argc, char **argv)
         { "cto-module",     required_argument, &found_ctom,      1 },
         { "enable-cto",     no_argument,       &enable_cto,      1 },
         { "version",        no_argument,       &version,         1 },
+        { "max-memory",     no_argument,       &max_memory,      1 },
+        { "macro-profile",  no_argument,       &macro_profile,   1 },
         { 0, 0, 0, 0 }
     };
 
@@ -297,6 +319,10 @@ main(int argc, char **argv)
     std::vector<std::string> so_paths;
     Generator generator;
 
+    if (macro_profile) {
+        MacroProfile::enable();
+    }
+
     bool generated =
         generator.run(&input_files,
                       &bitcode_paths,
@@ -316,6 +342,12 @@ main(int argc, char **argv)
                       enable_cto,
                       &so_paths,
                       output_file);
+    if (max_memory) {
+        printMaxMemory();
+    }
+    if (macro_profile) {
+        MacroProfile::print(stderr);
+    }
     if (!generated) {
         exit(1);
     }
@@ -0,0 +1,29 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+open my $fh, '>', 'embed-file.bin' or die $!;
+binmode $fh;
+print $fh pack('C*', 0x00, 0x01, 0x7F, 0xFF);
+close $fh;
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/embed-file.dt -o embed-file`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./embed-file`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [ 0, 1, 127, 255, 0, 1, 127, -1 ], 'Got expected results');
+
+`rm embed-file embed-file.bin`;
+
+1;
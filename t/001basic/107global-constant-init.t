@@ -0,0 +1,32 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# Global initialisers that reduce to constants, including sizeof and
+# offsetof, are used directly; others are still evaluated by way of
+# the JIT.
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/global-constant-init.dt -o global-constant-init`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./global-constant-init`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [ 'ok ok ok',
+                   '1.5 12',
+                   'a 2.5 c ok',
+                   'x 10 y 20' ],
+          'Global initialisers evaluated correctly');
+
+`rm global-constant-init`;
+
+1;
@@ -0,0 +1,29 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# Struct types are converted to LLVM types once per context, so
+# same-named structs in different namespaces, an opaque struct that
+# is defined later, and references to structs must each still get
+# the right type.
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/struct-lowering.dt -o struct-lowering`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./struct-lowering`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [ 'ok ok ok ok', '7 30' ], 'Got expected results');
+
+`rm struct-lowering`;
+
+1;
@@ -0,0 +1,28 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# Registered types are compared by identity, so const and reference
+# types must share their component types with the unqualified types,
+# for overloads and function pointer types to match.
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/qualified-types.dt -o qualified-types`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./qualified-types`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [ '1 2 3 3' ], 'Got expected results');
+
+`rm qualified-types`;
+
+1;
@@ -0,0 +1,73 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# Generated code may contain very long lists, very deeply nested
+# forms and very long string literals: none of these should be
+# subject to a fixed limit.
+
+my $element_count = 1000000;
+my $depth         = 10000;
+my $string_length = 100000;
+
+my $elements = join ' ', (0) x $element_count;
+my $nested   = ('(' x $depth).'x'.(')' x $depth);
+my $string   = 'a' x $string_length;
+
+open my $fh, '>', 'large-forms.dt' or die $!;
+print $fh <<EOF2;
+(import cstdio)
+(import cstring)
+(import macros)
+
+(def element-count
+  (macro intern (form)
+    (def count (var auto int 0))
+    (def current (var auto (p DNode) (@:@ form list-node)))
+    (while (not (null current))
+      (incv count)
+      (setv current (@:@ current next-node)))
+    (std.macros.mnfv mc count)))
+
+(def nesting-depth
+  (macro intern (form)
+    (def depth (var auto int 0))
+    (def current (var auto (p DNode) form))
+    (while (@:@ current is-list)
+      (incv depth)
+      (setv current (@:@ current list-node)))
+    (std.macros.mnfv mc depth)))
+
+(def identity
+  (macro intern (form)
+    form))
+
+(def main
+  (fn extern-c int (void)
+    (printf "%d\\n" (element-count ($elements)))
+    (printf "%d\\n" (nesting-depth $nested))
+    (printf "%d\\n" (cast (strlen (identity "$string")) int))
+    0))
+EOF2
+close $fh;
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} large-forms.dt -o large-forms`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./large-forms`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+is_deeply(\@res, [ $element_count, $depth, $string_length ],
+          'Got expected results');
+
+`rm large-forms large-forms.dt`;
+
+1;
@@ -0,0 +1,24 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/macro-arity.dt -o macro-arity`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./macro-arity`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [ 2, 9, 1, 136, 210 ], 'Got expected results');
+
+`rm macro-arity`;
+
+1;
@@ -0,0 +1,24 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/pure-macro.dt -o pure-macro`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./pure-macro`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [ '1 1 2 3 3 4' ], 'Pure macro expansions reused');
+
+`rm pure-macro`;
+
+1;
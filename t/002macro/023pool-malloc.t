@@ -0,0 +1,24 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/pool-malloc.dt -o pool-malloc`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./pool-malloc`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [ 20000 ], 'Got expected results');
+
+`rm pool-malloc`;
+
+1;
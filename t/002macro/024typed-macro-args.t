@@ -0,0 +1,27 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/typed-macro-args.dt -o typed-macro-args`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./typed-macro-args`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [ 'int', 'float', 'bool', 'char', 'string',
+                   'int pointer', 'int', 'int pointer', 'int',
+                   'untyped' ],
+          'Got expected results');
+
+`rm typed-macro-args`;
+
+1;
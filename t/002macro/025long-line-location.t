@@ -0,0 +1,64 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# Generated code is often written as a single long line, so column
+# numbers beyond the packed location range should still be correct,
+# both for lexed nodes and for nodes built by way of qq.
+
+my $padding = ' ' x 6000;
+
+my $qq_line = "$padding(def qq-column (macro intern (void) (qq column-of x)))";
+my $qq_column = index($qq_line, ' x)') + 2;
+
+my $main_line = "    (printf \"%d %d %d\\n\" (column-of $padding abc) "
+              . "(made-column) (qq-column))";
+my $main_column = index($main_line, 'abc') + 1;
+
+open my $fh, '>', 'long-line-location.dt' or die $!;
+print $fh <<EOF2;
+(import cstdio)
+(import macros)
+(import introspection)
+
+(using-namespace std.macros
+
+(def column-of
+  (macro intern (frm)
+    (mnfv mc (location-column mc (@:@ frm begin-location)))))
+
+(def made-column
+  (macro intern (void)
+    (mnfv mc (location-column mc (make-location mc 1 5000)))))
+
+$qq_line
+
+)
+
+(def main
+  (fn extern-c int (void)
+$main_line
+    0))
+EOF2
+close $fh;
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} long-line-location.dt -o long-line-location`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./long-line-location`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+is_deeply(\@res, [ "$main_column 5000 $qq_column" ],
+          'Got expected results');
+
+`rm long-line-location long-line-location.dt`;
+
+1;
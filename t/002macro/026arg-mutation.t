@@ -0,0 +1,29 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# A macro that modifies its argument's token string in place should
+# not affect the form from which that argument was taken, even where
+# that form is also used elsewhere in an expansion.
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/macro-arg-mutation.dt -o macro-arg-mutation`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./macro-arg-mutation`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [ 'abc', 'abc' ],
+          'Original forms unchanged after argument mutation');
+
+`rm macro-arg-mutation`;
+
+1;
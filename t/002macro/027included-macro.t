@@ -0,0 +1,28 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# A macro from an included file is called within that file, and then
+# again after the file's module has been linked into the including
+# module, at which point its compiled code is reused.
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/included-macro.dt -o included-macro`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./included-macro`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [ '10 42 8' ], 'Included macro works before and after linking');
+
+`rm included-macro`;
+
+1;
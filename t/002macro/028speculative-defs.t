@@ -0,0 +1,30 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# The arguments to an overloaded call are evaluated before it is known
+# whether the call is to a macro.  When it is, the variable and struct
+# defined by the argument have to be dropped again.  The anonymous
+# function is kept: it is added to the namespace used for anonymous
+# functions, outside the active namespace, under a new name.
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/speculative-defs.dt -o speculative-defs`;
+is($?, 0, 'Program compiled successfully');
+
+chomp for @res;
+is_deeply(\@res, [ 'no-var no-struct fn real-var' ],
+          'Speculative definitions removed on restore');
+
+@res = `./speculative-defs`;
+is($?, 0, 'Program executed successfully');
+
+`rm speculative-defs`;
+
+1;
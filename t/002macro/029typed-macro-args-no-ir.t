@@ -0,0 +1,37 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 5;
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/typed-macro-args-no-ir.dt -o typed-macro-args-no-ir`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./typed-macro-args-no-ir`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [ 'int', 'float', 'int pointer', 'int',
+                   'float pointer', 'float', 'float pointer' ],
+          'Got expected results');
+
+# The macro arguments are typed without generating code, so none of
+# the probe functions is called from main.
+
+@res = `dalec $ENV{"DALE_TEST_ARGS"} -s ir $test_dir/t/src/typed-macro-args-no-ir.dt -o typed-macro-args-no-ir.ll`;
+is(@res, 0, 'No compilation errors (IR)');
+
+open my $fh, '<', 'typed-macro-args-no-ir.ll' or die $!;
+my @calls = grep { /call.*tprobe/ } <$fh>;
+close $fh;
+is_deeply(\@calls, [], 'No code generated for macro arguments');
+
+`rm typed-macro-args-no-ir typed-macro-args-no-ir.ll`;
+
+1;
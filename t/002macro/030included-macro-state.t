@@ -0,0 +1,31 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 4;
+
+# A macro from an included file that updates a global variable is
+# called again after the file's module has been linked into the
+# including module.  Its code must then use the same copy of the
+# variable as a macro defined after linking.
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/included-macro-state.dt -o included-macro-state`;
+is(@res, 0, 'No compilation errors');
+
+@res = `./included-macro-state`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+my ($included, $counted, $seen) = split / /, $res[0];
+
+is($included, 1, 'Included macro called before linking');
+is($counted, $seen, 'Macros share global state after linking');
+
+`rm included-macro-state`;
+
+1;
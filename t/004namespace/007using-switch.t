@@ -0,0 +1,29 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# Unqualified lookups are cached, so each change to the namespaces in
+# use has to be reflected in the bindings that are found.
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/using-namespace-switch.dt -o using-namespace-switch  `;
+is(@res, 0, 'No compilation errors');
+
+@res = `./using-namespace-switch`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [
+    '0', '11 1', '22 3', '11 1', '0', '22 3', '11 22'
+], 'Got expected results');
+
+`rm using-namespace-switch`;
+
+1;
@@ -0,0 +1,32 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# Each call is resolved after a better overload has been added, so
+# results cached by the earlier calls must not be reused.
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/over-later.dt -o over-later `;
+is(@res, 0, 'No compilation errors');
+
+@res = `./over-later`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [
+    'int ...',
+    'int int ...',
+    'int int',
+    'int ...',
+], 'Later overloads are used once added');
+
+`rm over-later`;
+
+1;
@@ -0,0 +1,32 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# A macro that needs fewer (p DNode) arguments is preferred, and an
+# exact function match is preferred to both, even where they are
+# added after the call has been resolved once.
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/over-macro-later.dt -o over-macro-later `;
+is(@res, 0, 'No compilation errors');
+
+@res = `./over-macro-later`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [
+    'untyped untyped',
+    'int untyped',
+    'fn int int',
+], 'Later macro and function overloads are used once added');
+
+`rm over-macro-later`;
+
+1;
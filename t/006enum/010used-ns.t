@@ -0,0 +1,27 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# The enum is defined while a namespace containing a struct of the
+# same name is in use, but its type must still be its own struct.
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/enum-used-ns.dt -o enum-used-ns  `;
+is(@res, 0, 'No compilation errors');
+
+@res = `./enum-used-ns`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [ '2 ok' ], 'Got expected results');
+
+`rm enum-used-ns`;
+
+1;
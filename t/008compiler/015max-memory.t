@@ -0,0 +1,25 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 4;
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} --max-memory $test_dir/t/src/hello-world.dt -o max-memory 2>&1`;
+is($?, 0, 'Program compiled successfully');
+chomp for @res;
+
+is(@res, 1, 'Got one line of compiler output');
+like($res[0], qr/maximum memory usage: \d+ KB$/,
+     'Got maximum memory usage');
+
+@res = `./max-memory`;
+is($?, 0, 'Program executed successfully');
+
+`rm max-memory`;
+
+1;
@@ -0,0 +1,30 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 6;
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} --macro-profile $test_dir/t/src/macro-arity.dt -o macro-profile 2>&1`;
+is($?, 0, 'Program compiled successfully');
+chomp for @res;
+
+like($res[0], qr/^macro\s+calls\s+compile-ms\s+execute-ms\s+total-ms\s+nodes\s+depth$/,
+     'Got macro report header');
+ok((grep { /^sum-args\s+3\s+[\d.]+\s+[\d.]+\s+[\d.]+\s+3\s+0$/ } @res),
+   'Got macro statistics');
+ok((grep { /^call site\s+macro\s+calls\s+total-ms$/ } @res),
+   'Got call site report header');
+ok((grep { /macro-arity\.dt:\d+:\d+\s+second\s+1\s+[\d.]+$/ } @res),
+   'Got call site statistics');
+
+@res = `./macro-profile`;
+is($?, 0, 'Program executed successfully');
+
+`rm macro-profile`;
+
+1;
@@ -0,0 +1,91 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 7;
+
+# Error messages, module files and global initialisers should not be
+# subject to fixed-size buffers.
+
+my $name = 'a' x 5000;
+
+open my $fh, '>', 'long-error.dt' or die $!;
+print $fh <<EOF2;
+(def main
+  (fn extern-c int (void)
+    (def x (var auto $name))
+    0))
+EOF2
+close $fh;
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} long-error.dt -o long-error 2>&1`;
+chomp for @res;
+is(@res, 1, 'Got one compilation error');
+like($res[0], qr/error: type not in scope: '$name'$/,
+     'Error message includes the full name');
+
+open $fh, '>', 'long-name-module.dt' or die $!;
+print $fh <<EOF2;
+(module longname)
+
+(def $name
+  (fn extern int (void)
+    42))
+EOF2
+close $fh;
+
+@res = `dalec -O0 -o ./t.long-name-module.o -c long-name-module.dt`;
+is_deeply(\@res, [], 'No compilation errors (module)');
+
+my $members = join "\n", map { "(m$_ int)" } (0..99);
+
+open $fh, '>', 'long-name-user.dt' or die $!;
+print $fh <<EOF2;
+(import cstdio)
+(import longname)
+
+(def big (struct intern ($members)))
+
+(def make-big
+  (fn intern big (void)
+    (def b (var auto big))
+    (setf (: b m0) 1)
+    (setf (: b m99) ($name))
+    (return b)))
+
+(def global-big (var intern big (make-big)))
+
+(def main
+  (fn extern-c int (void)
+    (printf "%d %d\\n" (@: global-big m0) (@: global-big m99))
+    0))
+EOF2
+close $fh;
+
+@res = `dalec $ENV{"DALE_TEST_ARGS"} long-name-user.dt -o long-name-user`;
+is_deeply(\@res, [], 'No compilation errors');
+
+@res = `./long-name-user`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+is(@res, 1, 'Got one line of output');
+is($res[0], '1 42', 'Got expected results');
+
+`rm long-error.dt`;
+`rm long-name-module.dt`;
+`rm long-name-user.dt`;
+`rm long-name-user`;
+`rm liblongname.dtm`;
+`rm liblongname-nomacros.bc`;
+`rm liblongname.bc`;
+`rm liblongname.so`;
+`rm liblongname-nomacros.so`;
+`rm t.long-name-module.o`;
+
+1;
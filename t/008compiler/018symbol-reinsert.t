@@ -0,0 +1,58 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# Each variable is first defined within the argument to an overloaded
+# macro call, so it is erased from the symbol table when the save
+# point is restored, and is then defined again.  There are enough of
+# them for the table to be rebuilt along the way.
+
+my $count = 200;
+my $forms = join "\n", map {
+    "    (probe (do (def v$_ (var auto int 1000)) v$_))\n"
+  . "    (def v$_ (var auto int $_))\n"
+  . "    (setv total (+ total v$_))"
+} (0..($count - 1));
+
+open my $fh, '>', 'symbol-reinsert.dt' or die $!;
+print $fh <<EOF2;
+(import cstdio)
+(import macros)
+
+(def probe
+  (macro intern (frm)
+    (std.macros.mnfv mc 0)))
+
+(def probe
+  (fn intern int ((a int) (b int))
+    0))
+
+(def main
+  (fn extern-c int (void)
+    (def total (var auto int 0))
+$forms
+    (printf "%d\\n" total)
+    0))
+EOF2
+close $fh;
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} symbol-reinsert.dt -o symbol-reinsert`;
+is_deeply(\@res, [], 'No compilation errors');
+
+@res = `./symbol-reinsert`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+is_deeply(\@res, [ ($count * ($count - 1)) / 2 ],
+          'Reinserted variables have their new values');
+
+`rm symbol-reinsert.dt symbol-reinsert`;
+
+1;
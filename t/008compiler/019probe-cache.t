@@ -0,0 +1,35 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 3;
+
+# has-errors results are cached, so repeating a probe does not expand
+# the macro in its form again.  Defining a variable, a function or
+# the body of an opaque struct must discard the cached results.
+# exists-fn results are cached by function name and parameter types,
+# and must be discarded when an overload is added for that name.
+
+my @res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/probe-cache.dt -o probe-cache`;
+is($?, 0, 'Program compiled successfully');
+
+chomp for @res;
+
+is_deeply(\@res, [
+    'noisy', '1', '1', 'noisy', '0',
+    'noisy', '1', '1', 'noisy', '0',
+    'noisy', '1', '1', 'noisy', '0',
+    '0', '0', '1',
+], 'Probe results reused until bindings change');
+
+@res = `./probe-cache`;
+is($?, 0, 'Program executed successfully');
+
+`rm probe-cache`;
+
+1;
@@ -0,0 +1,38 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 4;
+
+# The Counted concept macro has no guard of its own: it reports each
+# expansion, and a second expansion would redefine counted-size.  The
+# instantiation in the module must be recorded, so that the
+# instantiations in the importing file expand to nothing.
+
+my @res = `dalec -O0 -o ./t.dtm-instantiation.o -c $test_dir/t/src/dtm-instantiation.dt`;
+is_deeply(\@res, [ "expanding Counted\n" ],
+          'No compilation errors, macro expanded once');
+
+@res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/dtm-instantiation-user.dt -o dtm-instantiation-user`;
+is_deeply(\@res, [], 'No compilation errors, macro not expanded again');
+
+@res = `./dtm-instantiation-user`;
+is($?, 0, 'Program executed successfully');
+
+chomp for @res;
+is_deeply(\@res, [ '7' ], 'Got expected results');
+
+`rm libcountedint.dtm`;
+`rm libcountedint-nomacros.bc`;
+`rm libcountedint.bc`;
+`rm libcountedint.so`;
+`rm libcountedint-nomacros.so`;
+`rm t.dtm-instantiation.o`;
+`rm dtm-instantiation-user`;
+
+1;
@@ -0,0 +1,50 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 8;
+
+# Both modules include the same 'once' file, so the second module's
+# copies of its functions are erased on import.  The imported macros
+# are called by way of the module libraries, and the modules' bitcode
+# is only read in full when they are linked statically.
+
+my @res = `dalec -O0 $test_dir/t/src/dtm-once-a.dt -o ./t.dtm-once-macros.o -c -m ./dtm-once-a`;
+is_deeply(\@res, [], 'no compilation errors');
+   @res = `dalec -O0 $test_dir/t/src/dtm-once-b.dt -o ./t.dtm-once-macros.o -c -m ./dtm-once-b`;
+is_deeply(\@res, [], 'no compilation errors');
+
+@res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/dtm-once-user.dt -o dtm-once-user`;
+chomp for @res;
+is_deeply(\@res, [], 'no compilation errors (dynamic)');
+
+@res = `./dtm-once-user`;
+is($?, 0, 'Program executed successfully (dynamic)');
+chomp for @res;
+is_deeply(\@res, [ '42 42 43 44' ], 'Got expected results (dynamic)');
+
+@res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/dtm-once-user.dt -o dtm-once-user --static-modules`;
+chomp for @res;
+is_deeply(\@res, [], 'no compilation errors (static)');
+
+@res = `./dtm-once-user`;
+is($?, 0, 'Program executed successfully (static)');
+chomp for @res;
+is_deeply(\@res, [ '42 42 43 44' ], 'Got expected results (static)');
+
+for my $name (qw(dtm-once-a dtm-once-b)) {
+    `rm lib$name.so`;
+    `rm lib$name-nomacros.so`;
+    `rm lib$name.dtm`;
+    `rm lib$name.bc`;
+    `rm lib$name-nomacros.bc`;
+}
+`rm dtm-once-user`;
+`rm t.dtm-once-macros.o`;
+
+1;
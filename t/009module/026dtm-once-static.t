@@ -0,0 +1,41 @@
+#!/usr/bin/perl
+
+use warnings;
+use strict;
+$ENV{"DALE_TEST_ARGS"} ||= "";
+my $test_dir = $ENV{"DALE_TEST_DIR"} || ".";
+$ENV{PATH} .= ":.";
+
+use Data::Dumper;
+use Test::More tests => 5;
+
+# dtm-once-a is imported second, so its copies of the 'once'
+# functions are erased on import.  Linking only that module statically
+# reads its bitcode in full, after which those functions must be
+# erased again.
+
+my @res = `dalec -O0 $test_dir/t/src/dtm-once-a.dt -o ./t.dtm-once-static.o -c -m ./dtm-once-a`;
+is_deeply(\@res, [], 'no compilation errors');
+   @res = `dalec -O0 $test_dir/t/src/dtm-once-b.dt -o ./t.dtm-once-static.o -c -m ./dtm-once-b`;
+is_deeply(\@res, [], 'no compilation errors');
+
+@res = `dalec $ENV{"DALE_TEST_ARGS"} $test_dir/t/src/dtm-once-user-rev.dt -o dtm-once-user-rev --static-module=dtm-once-a`;
+chomp for @res;
+is_deeply(\@res, [], 'no compilation errors');
+
+@res = `./dtm-once-user-rev`;
+is($?, 0, 'Program executed successfully');
+chomp for @res;
+is_deeply(\@res, [ '42 43' ], 'Got expected results');
+
+for my $name (qw(dtm-once-a dtm-once-b)) {
+    `rm lib$name.so`;
+    `rm lib$name-nomacros.so`;
+    `rm lib$name.dtm`;
+    `rm lib$name.bc`;
+    `rm lib$name-nomacros.bc`;
+}
+`rm dtm-once-user-rev`;
+`rm t.dtm-once-static.o`;
+
+1;